@@ -0,0 +1,195 @@
+// AsyncLogger.cpp
+#include <charconv>
+#include "AsyncLogger.h"
+
+namespace AsyncLogger
+{
+    namespace
+    {
+        void appendArg(std::string &message, const Arg &arg)
+        {
+            if (const auto *text = std::get_if<std::string>(&arg))
+            {
+                message += *text;
+                return;
+            }
+
+            char buffer[32];
+            auto result = std::holds_alternative<long long>(arg)
+                ? std::to_chars(buffer, buffer + sizeof(buffer), std::get<long long>(arg))
+                : std::to_chars(buffer, buffer + sizeof(buffer), std::get<double>(arg));
+            message.append(buffer, result.ptr);
+        }
+
+        std::string format(const Entry &entry)
+        {
+            std::string message;
+            size_t nextArg = 0;
+            for (const char *c = entry.format; *c; c++)
+            {
+                if (c[0] == '{' && c[1] == '}' && nextArg < entry.argCount)
+                {
+                    appendArg(message, entry.args[nextArg++]);
+                    c++;
+                }
+                else
+                {
+                    message += *c;
+                }
+            }
+            return message;
+        }
+    }
+
+    std::optional<Level> parseLevel(std::string_view name)
+    {
+        for (size_t i = 0; i < LEVEL_NAMES.size(); i++)
+        {
+            if (LEVEL_NAMES[i] == name)
+            {
+                return static_cast<Level>(i);
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::optional<Category> parseCategory(std::string_view name)
+    {
+        for (size_t i = 0; i < CATEGORY_NAMES.size(); i++)
+        {
+            if (CATEGORY_NAMES[i] == name)
+            {
+                return static_cast<Category>(i);
+            }
+        }
+        return std::nullopt;
+    }
+
+    AsyncLogger::AsyncLogger(PluginSDK::Logger::LoggerAPI &sink, Metrics::Registry &metrics)
+        : sink_(sink),
+          dropped_(metrics.counter("log.dropped")),
+          suppressed_(metrics.counter("log.suppressed")),
+          ring_(std::make_unique<Cell[]>(RING_CAPACITY))
+    {
+#ifdef DEBUG
+        Level defaultLevel = Level::Debug;
+#else
+        Level defaultLevel = Level::Info;
+#endif
+        for (auto &level : levels_)
+        {
+            level.store(defaultLevel, std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < RING_CAPACITY; i++)
+        {
+            ring_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    void AsyncLogger::setLevel(Category category, Level level)
+    {
+        levels_[static_cast<size_t>(category)].store(level, std::memory_order_relaxed);
+    }
+
+    void AsyncLogger::push(Entry &&entry)
+    {
+        size_t position = enqueuePosition_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell &cell = ring_[position & (RING_CAPACITY - 1)];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (difference == 0)
+            {
+                if (enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.entry = std::move(entry);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return;
+                }
+            }
+            else if (difference < 0)
+            {
+                // Full, the drainer is behind: losing a line beats blocking a poller
+                dropped_.add();
+                return;
+            }
+            else
+            {
+                position = enqueuePosition_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void AsyncLogger::drain(void)
+    {
+        std::lock_guard<std::mutex> lock(drainMutex_);
+        auto now = std::chrono::steady_clock::now();
+
+        while (true)
+        {
+            Cell &cell = ring_[dequeuePosition_ & (RING_CAPACITY - 1)];
+            if (cell.sequence.load(std::memory_order_acquire) != dequeuePosition_ + 1)
+            {
+                break;
+            }
+            Entry entry = std::move(cell.entry);
+            cell.sequence.store(dequeuePosition_ + RING_CAPACITY, std::memory_order_release);
+            dequeuePosition_++;
+
+            // The same message within DUPLICATE_WINDOW is only counted
+            std::string message = format(entry);
+            auto recent = recent_.find(message);
+            if (recent != recent_.end() && now - recent->second.firstSeen < DUPLICATE_WINDOW)
+            {
+                recent->second.repeats++;
+                suppressed_.add();
+                continue;
+            }
+            if (recent != recent_.end())
+            {
+                if (recent->second.repeats > 0)
+                {
+                    forward(entry.level, "Previous message repeated " + std::to_string(recent->second.repeats) + " times: " + message);
+                }
+                recent->second = Recent{now, entry.level, 0};
+            }
+            else
+            {
+                recent_.emplace(message, Recent{now, entry.level, 0});
+            }
+            forward(entry.level, message);
+        }
+
+        // Report the repeats of messages that stopped coming
+        for (auto it = recent_.begin(); it != recent_.end();)
+        {
+            if (now - it->second.firstSeen < DUPLICATE_WINDOW)
+            {
+                ++it;
+                continue;
+            }
+            if (it->second.repeats > 0)
+            {
+                forward(it->second.level, "Previous message repeated " + std::to_string(it->second.repeats) + " times: " + it->first);
+            }
+            it = recent_.erase(it);
+        }
+    }
+
+    void AsyncLogger::forward(Level level, const std::string &message)
+    {
+        switch (level)
+        {
+            case Level::Error:
+                sink_.error(message);
+                break;
+            case Level::Warning:
+                sink_.warning(message);
+                break;
+            default:
+                sink_.info(message);
+                break;
+        }
+    }
+}
@@ -0,0 +1,158 @@
+// AsyncLogger.h
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+#include <NeoRadarSDK/SDK.h>
+#include "Metrics.h"
+
+namespace AsyncLogger
+{
+    const size_t RING_CAPACITY = 1024; // Entries waiting for the drainer, power of two
+    const size_t MAX_ARGS = 6;
+    const std::chrono::milliseconds DRAIN_INTERVAL = std::chrono::milliseconds(100);
+    const std::chrono::seconds DUPLICATE_WINDOW = std::chrono::seconds(10); // Identical messages are shown once per window
+
+    enum class Level : uint8_t
+    {
+        Debug,
+        Info,
+        Warning,
+        Error,
+        Off
+    };
+
+    enum class Category : uint8_t
+    {
+        General,
+        Gate,
+        Oceanic,
+        Count
+    };
+
+    const std::array<std::string_view, 5> LEVEL_NAMES = {"debug", "info", "warning", "error", "off"};
+    const std::array<std::string_view, static_cast<size_t>(Category::Count)> CATEGORY_NAMES = {"general", "gate", "oceanic"};
+
+    std::optional<Level> parseLevel(std::string_view name);
+    std::optional<Category> parseCategory(std::string_view name);
+
+    // Strings up to the small string size are stored without allocating
+    using Arg = std::variant<long long, double, std::string>;
+
+    // Log call recorded as is, formatted by the drainer. format must be a string literal
+    // where every "{}" is replaced by the next argument.
+    struct Entry
+    {
+        Level level = Level::Info;
+        Category category = Category::General;
+        const char *format = "";
+        std::array<Arg, MAX_ARGS> args;
+        size_t argCount = 0;
+    };
+
+    // Logging front-end of the plugin. Any thread records entries in a bounded lock-free
+    // ring, disabled levels cost a single atomic load. The drainer job formats them,
+    // folds repeated messages and forwards them to the SDK logger.
+    class AsyncLogger
+    {
+        public:
+            AsyncLogger(PluginSDK::Logger::LoggerAPI &sink, Metrics::Registry &metrics);
+
+            void setLevel(Category category, Level level);
+            bool enabled(Category category, Level level) const
+            {
+                return level >= levels_[static_cast<size_t>(category)].load(std::memory_order_relaxed);
+            }
+
+            template <typename... Args>
+            void debug(Category category, const char *format, Args &&...args) { log(Level::Debug, category, format, std::forward<Args>(args)...); }
+            template <typename... Args>
+            void info(Category category, const char *format, Args &&...args) { log(Level::Info, category, format, std::forward<Args>(args)...); }
+            template <typename... Args>
+            void warning(Category category, const char *format, Args &&...args) { log(Level::Warning, category, format, std::forward<Args>(args)...); }
+            template <typename... Args>
+            void error(Category category, const char *format, Args &&...args) { log(Level::Error, category, format, std::forward<Args>(args)...); }
+
+            template <typename... Args>
+            void log(Level level, Category category, const char *format, Args &&...args)
+            {
+                static_assert(sizeof...(Args) <= MAX_ARGS, "Too many log arguments");
+                if (!enabled(category, level))
+                {
+                    return;
+                }
+                Entry entry;
+                entry.level = level;
+                entry.category = category;
+                entry.format = format;
+                entry.argCount = sizeof...(Args);
+                [[maybe_unused]] size_t i = 0;
+                ((entry.args[i++] = toArg(std::forward<Args>(args))), ...);
+                push(std::move(entry));
+            }
+
+            // Format and forward everything recorded so far, run by the drainer job and on shutdown
+            void drain(void);
+
+        private:
+            struct Cell
+            {
+                std::atomic<size_t> sequence;
+                Entry entry;
+            };
+
+            struct Recent
+            {
+                std::chrono::steady_clock::time_point firstSeen;
+                Level level;
+                size_t repeats = 0;
+            };
+
+            PluginSDK::Logger::LoggerAPI &sink_;
+            Metrics::Counter &dropped_;
+            Metrics::Counter &suppressed_;
+            std::array<std::atomic<Level>, static_cast<size_t>(Category::Count)> levels_;
+
+            // Bounded multi-producer queue, each cell sequence tells whose turn it is
+            std::unique_ptr<Cell[]> ring_;
+            alignas(64) std::atomic<size_t> enqueuePosition_ = 0;
+            alignas(64) size_t dequeuePosition_ = 0;
+
+            // Drainer state
+            std::mutex drainMutex_;
+            std::unordered_map<std::string, Recent> recent_;
+
+            void push(Entry &&entry);
+            void forward(Level level, const std::string &message);
+
+            template <typename T>
+            static Arg toArg(T &&value)
+            {
+                using Value = std::decay_t<T>;
+                if constexpr (std::is_same_v<Value, bool>)
+                {
+                    return std::string(value ? "true" : "false");
+                }
+                else if constexpr (std::is_integral_v<Value> || std::is_enum_v<Value>)
+                {
+                    return static_cast<long long>(value);
+                }
+                else if constexpr (std::is_floating_point_v<Value>)
+                {
+                    return static_cast<double>(value);
+                }
+                else
+                {
+                    return std::string(std::forward<T>(value));
+                }
+            }
+    };
+}
@@ -0,0 +1,92 @@
+// CircuitBreaker.cpp
+#include <algorithm>
+#include "CircuitBreaker.h"
+
+namespace CircuitBreaker
+{
+    CircuitBreaker::CircuitBreaker(const std::string &name, AsyncLogger::AsyncLogger &logger, Metrics::Registry &metrics, std::chrono::milliseconds baseBackoff)
+        : name_(name),
+          baseBackoff_(baseBackoff),
+          logger_(logger),
+          stateGauge_(metrics.gauge(name + ".breaker.state")),
+          rejected_(metrics.counter(name + ".breaker.rejected")),
+          random_(std::random_device()())
+    {
+    }
+
+    bool CircuitBreaker::allowRequest(void)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (state_ == State::Closed)
+        {
+            return true;
+        }
+        if (state_ == State::Open && std::chrono::steady_clock::now() >= retryAt_)
+        {
+            state_ = State::HalfOpen;
+            stateGauge_.set(static_cast<int64_t>(state_));
+            return true;
+        }
+        rejected_.add();
+        return false;
+    }
+
+    void CircuitBreaker::recordSuccess(void)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (state_ != State::Closed)
+        {
+            logger_.info(AsyncLogger::Category::General, "{} is back, closing circuit breaker", name_);
+        }
+        state_ = State::Closed;
+        consecutiveFailures_ = 0;
+        openCount_ = 0;
+        stateGauge_.set(static_cast<int64_t>(state_));
+    }
+
+    void CircuitBreaker::recordFailure(void)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        consecutiveFailures_++;
+        if (state_ == State::HalfOpen || (state_ == State::Closed && consecutiveFailures_ >= FAILURE_THRESHOLD))
+        {
+            open();
+        }
+    }
+
+    void CircuitBreaker::abandonProbe(void)
+    {
+        // The backoff has already expired, the probe is allowed again straight away
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (state_ == State::HalfOpen)
+        {
+            state_ = State::Open;
+            stateGauge_.set(static_cast<int64_t>(state_));
+        }
+    }
+
+    State CircuitBreaker::state(void)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return state_;
+    }
+
+    bool CircuitBreaker::isFailureStatus(int status)
+    {
+        return status == 0 || status == 408 || status == 429 || status >= 500;
+    }
+
+    void CircuitBreaker::open(void)
+    {
+        // Backoff doubles on every failed probe, with up to 25% jitter so instances do not probe together
+        std::chrono::milliseconds backoff = std::min(MAX_BACKOFF, baseBackoff_ * (1 << std::min(openCount_, 10)));
+        std::uniform_int_distribution<long long> jitter(0, backoff.count() / 4);
+        backoff = std::min(MAX_BACKOFF, backoff + std::chrono::milliseconds(jitter(random_)));
+        openCount_++;
+
+        state_ = State::Open;
+        retryAt_ = std::chrono::steady_clock::now() + backoff;
+        stateGauge_.set(static_cast<int64_t>(state_));
+        logger_.warning(AsyncLogger::Category::General, "{} is failing, circuit breaker open for {} s", name_, backoff.count() / 1000);
+    }
+}
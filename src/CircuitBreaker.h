@@ -0,0 +1,60 @@
+// CircuitBreaker.h
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <string>
+#include <NeoRadarSDK/SDK.h>
+#include "AsyncLogger.h"
+#include "Metrics.h"
+
+namespace CircuitBreaker
+{
+    const int FAILURE_THRESHOLD = 3; // Consecutive failures before the breaker opens
+    const std::chrono::milliseconds BASE_BACKOFF = std::chrono::seconds(15);
+    const std::chrono::milliseconds MAX_BACKOFF = std::chrono::minutes(10);
+
+    enum class State
+    {
+        Closed,     // Requests go through
+        Open,       // Requests fail fast until the backoff expires
+        HalfOpen    // A single probe request is in flight
+    };
+
+    // Per-endpoint breaker with exponential, jittered backoff between probes
+    class CircuitBreaker
+    {
+        public:
+            CircuitBreaker(const std::string &name, AsyncLogger::AsyncLogger &logger, Metrics::Registry &metrics,
+                std::chrono::milliseconds baseBackoff = BASE_BACKOFF);
+
+            // False while open; once the backoff has expired a single probe is let through
+            bool allowRequest(void);
+            void recordSuccess(void);
+            void recordFailure(void);
+
+            // Hand back a probe allowed but never sent, e.g. refused by the rate limiter, so the next call probes again
+            void abandonProbe(void);
+
+            State state(void);
+
+            // Whether an HTTP status means the endpoint is unhealthy, 0 meaning no response
+            static bool isFailureStatus(int status);
+
+        private:
+            std::string name_;
+            std::chrono::milliseconds baseBackoff_;
+            AsyncLogger::AsyncLogger &logger_;
+            Metrics::Gauge &stateGauge_;
+            Metrics::Counter &rejected_;
+
+            std::mutex mutex_;
+            State state_ = State::Closed;
+            int consecutiveFailures_ = 0;
+            int openCount_ = 0;
+            std::chrono::steady_clock::time_point retryAt_;
+            std::mt19937 random_;
+
+            void open(void);
+    };
+}
@@ -15,19 +15,69 @@ void CoFrancePlugin::Initialize(const PluginSDK::PluginMetadata &metadata, Plugi
     logger_ = &coreAPI_->logger();
 
     logger_->info("Initializing CoFrance " + metadata.version);
-    gateAssigner_ = std::make_unique<GateAssigner::GateAssigner>(
+    config_ = Config::loadConfig(*logger_);
+    metrics_ = std::make_unique<Metrics::Registry>();
+    asyncLogger_ = std::make_unique<AsyncLogger::AsyncLogger>(*logger_, *metrics_);
+    applyLogLevels();
+    scheduler_ = std::make_unique<Scheduler::Scheduler>();
+    scheduler_->start();
+    scheduler_->addJob("Log drain", AsyncLogger::DRAIN_INTERVAL, std::chrono::milliseconds(0),
+        [this](const std::atomic<bool> &) { asyncLogger_->drain(); },
+        AsyncLogger::DRAIN_INTERVAL);
+    scheduler_->addJob("Metrics", Metrics::SUMMARY_INTERVAL, std::chrono::milliseconds(0),
+        [this](const std::atomic<bool> &) { logger_->info("Metrics: " + metrics_->summary()); },
+        Metrics::SUMMARY_INTERVAL);
+    // Runs the pollers and their stand queries: enough threads for the queries allowed in flight, at least one per core
+    size_t maxConcurrentRequests = config_.gateMaxConcurrentRequests > 0 ? static_cast<size_t>(config_.gateMaxConcurrentRequests) : GateAssigner::MAX_CONCURRENT_REQUESTS;
+    workerPool_ = std::make_unique<WorkerPool::WorkerPool>(std::max<size_t>(std::thread::hardware_concurrency(), maxConcurrentRequests));
+    httpClientPool_ = std::make_unique<HttpClientPool::HttpClientPool>();
+    snapshotProvider_ = std::make_unique<Snapshot::SnapshotProvider>(
         coreAPI_->aircraft(),
         coreAPI_->flightplan(),
+        coreAPI_->controllerData(),
+        GateAssigner::GateAssigner::snapshotMaxAge(config_)
+    );
+    tagUpdateQueue_ = std::make_unique<TagUpdateQueue::TagUpdateQueue>(coreAPI_->tag(), *metrics_);
+    scheduler_->addJob("Tag dispatch", TagUpdateQueue::DISPATCH_INTERVAL, std::chrono::milliseconds(0),
+        [this](const std::atomic<bool> &) { tagUpdateQueue_->dispatch(); });
+    diskCache_ = std::make_unique<DiskCache::DiskCache>(Config::getPluginDirectory() / DiskCache::CACHE_DIRECTORY, *asyncLogger_);
+    sharedCache_ = std::make_unique<SharedCache::SharedCache>(Config::getPluginDirectory() / DiskCache::CACHE_DIRECTORY, *asyncLogger_);
+    gateAssigner_ = std::make_unique<GateAssigner::GateAssigner>(
+        *snapshotProvider_,
         coreAPI_->tag(),
-        *logger_
+        *tagUpdateQueue_,
+        *asyncLogger_,
+        *httpClientPool_,
+        *scheduler_,
+        *workerPool_,
+        config_,
+        *metrics_,
+        *diskCache_,
+        *sharedCache_
     );
     oceanicClearance_ = std::make_unique<OceanicClearance::OceanicClearance>(
-        coreAPI_->controllerData(),
-        coreAPI_->flightplan(),
+        *snapshotProvider_,
         coreAPI_->tag(),
-        *logger_
+        *tagUpdateQueue_,
+        *asyncLogger_,
+        *httpClientPool_,
+        *scheduler_,
+        *workerPool_,
+        config_,
+        *metrics_,
+        *diskCache_,
+        *sharedCache_
     );
 
+    // Register the chat commands
+    commandProvider_ = std::make_shared<CoFranceCommandProvider>(*this);
+    PluginSDK::Chat::CommandDefinition definition;
+    definition.name = "cofrance metrics";
+    definition.description = "Dump CoFrance metrics to " + Metrics::DUMP_FILE_NAME;
+    definition.lastParameterHasSpaces = false;
+    definition.parameters.clear();
+    metricsCommandId_ = coreAPI_->chat().registerCommand(definition.name, definition, commandProvider_);
+
     if (isConnected())
     {
         gateAssigner_->startPoller();
@@ -42,11 +92,24 @@ void CoFrancePlugin::Shutdown()
 {
     if (initialized_)
     {
+        initialized_ = false;
+        coreAPI_->chat().unregisterCommand(metricsCommandId_);
+        commandProvider_.reset();
         gateAssigner_.get()->stopPoller();
         gateAssigner_.reset();
         oceanicClearance_.get()->stopPoller();
         oceanicClearance_.reset();
-        initialized_ = false;
+        scheduler_->stop();
+        scheduler_.reset();
+        workerPool_.reset();
+        sharedCache_.reset();
+        diskCache_.reset();
+        tagUpdateQueue_.reset();
+        snapshotProvider_.reset();
+        httpClientPool_.reset();
+        asyncLogger_->drain();
+        asyncLogger_.reset();
+        metrics_.reset();
         logger_->info("CoFrance shutdown complete");
     }
 }
@@ -69,7 +132,35 @@ void CoFrancePlugin::OnFsdConnected(const PluginSDK::Fsd::FsdConnectedEvent* eve
 void CoFrancePlugin::OnFsdDisconnected(const PluginSDK::Fsd::FsdDisconnectedEvent* event)
 {
     gateAssigner_->stopPoller();
-    oceanicClearance_->stopPoller();        
+    oceanicClearance_->stopPoller();
+
+    // The client resets the tags, updates still waiting would show stale values after a reconnect
+    tagUpdateQueue_->clear();
+}
+
+void CoFrancePlugin::OnFlightplanUpdated(const PluginSDK::Flightplan::FlightplanUpdatedEvent* event)
+{
+    if (initialized_)
+    {
+        gateAssigner_->markDirty(event->callsign);
+        oceanicClearance_->markDirty(event->callsign);
+    }
+}
+
+void CoFrancePlugin::OnFlightplanRemoved(const PluginSDK::Flightplan::FlightplanRemovedEvent* event)
+{
+    if (initialized_)
+    {
+        oceanicClearance_->markDirty(event->callsign);
+    }
+}
+
+void CoFrancePlugin::OnControllerDataUpdated(const PluginSDK::ControllerData::ControllerDataUpdatedEvent* event)
+{
+    if (initialized_)
+    {
+        oceanicClearance_->markDirty(event->callsign);
+    }
 }
 
 bool CoFrancePlugin::isConnected() const
@@ -101,3 +192,51 @@ bool CoFrancePlugin::isConnectedAsCTR() const
     }
     return false;
 }
+
+
+void CoFrancePlugin::applyLogLevels(void)
+{
+    for (const auto &[name, levelName] : config_.logLevels)
+    {
+        auto level = AsyncLogger::parseLevel(levelName);
+        auto category = AsyncLogger::parseCategory(name);
+        if (!level || (!category && name != "default"))
+        {
+            logger_->warning("Ignoring invalid log level " + name + " = '" + levelName + "'");
+            continue;
+        }
+        if (category)
+        {
+            asyncLogger_->setLevel(*category, *level);
+            continue;
+        }
+        for (size_t i = 0; i < static_cast<size_t>(AsyncLogger::Category::Count); i++)
+        {
+            // Categories set explicitly win over the default whatever the order
+            if (!config_.logLevels.contains(std::string(AsyncLogger::CATEGORY_NAMES[i])))
+            {
+                asyncLogger_->setLevel(static_cast<AsyncLogger::Category>(i), *level);
+            }
+        }
+    }
+}
+
+PluginSDK::Chat::CommandResult CoFranceCommandProvider::Execute(const std::string &commandId, const std::vector<std::string> &args)
+{
+    return plugin_.executeCommand(commandId, args);
+}
+
+PluginSDK::Chat::CommandResult CoFrancePlugin::executeCommand(const std::string &commandId, const std::vector<std::string> &args)
+{
+    if (commandId == metricsCommandId_)
+    {
+        std::filesystem::path path = Config::getPluginDirectory() / Metrics::DUMP_FILE_NAME;
+        if (!metrics_->dumpToFile(path))
+        {
+            return {false, "Failed to write " + path.string()};
+        }
+        logger_->info("Metrics written to " + path.string());
+        return {true, std::nullopt};
+    }
+    return {false, "Unknown command"};
+}
\ No newline at end of file
@@ -1,9 +1,31 @@
 // CoFrance.h
 #pragma once
 #include <NeoRadarSDK/SDK.h>
+#include "AsyncLogger.h"
+#include "Config.h"
+#include "DiskCache.h"
+#include "HttpClientPool.h"
+#include "Metrics.h"
+#include "Scheduler.h"
+#include "SharedCache.h"
+#include "Snapshot.h"
+#include "TagUpdateQueue.h"
+#include "WorkerPool.h"
 #include "GateAssigner.h"
 #include "OceanicClearance.h"
 
+class CoFrancePlugin;
+
+// Chat commands of the plugin
+class CoFranceCommandProvider : public PluginSDK::Chat::CommandProvider
+{
+public:
+    explicit CoFranceCommandProvider(CoFrancePlugin &plugin) : plugin_(plugin) {}
+    PluginSDK::Chat::CommandResult Execute(const std::string &commandId, const std::vector<std::string> &args) override;
+
+private:
+    CoFrancePlugin &plugin_;
+};
 
 class CoFrancePlugin : public PluginSDK::BasePlugin
 {
@@ -18,10 +40,17 @@ public:
     // Events
     void OnFsdConnected(const PluginSDK::Fsd::FsdConnectedEvent* event) override;
     void OnFsdDisconnected(const PluginSDK::Fsd::FsdDisconnectedEvent* event) override;
+    void OnFlightplanUpdated(const PluginSDK::Flightplan::FlightplanUpdatedEvent* event) override;
+    void OnFlightplanRemoved(const PluginSDK::Flightplan::FlightplanRemovedEvent* event) override;
+    void OnControllerDataUpdated(const PluginSDK::ControllerData::ControllerDataUpdatedEvent* event) override;
     
     bool isConnected() const;
     bool isConnectedAsController() const;
     bool isConnectedAsCTR() const;
+    void applyLogLevels(void);
+
+    // Commands
+    PluginSDK::Chat::CommandResult executeCommand(const std::string &commandId, const std::vector<std::string> &args);
     
 private:
     bool initialized_ = false;
@@ -29,7 +58,19 @@ private:
     PluginSDK::ClientInformation clientInfo_;
     PluginSDK::CoreAPI *coreAPI_ = nullptr;
     PluginSDK::Logger::LoggerAPI *logger_ = nullptr;
+    Config::Config config_;
+    std::shared_ptr<CoFranceCommandProvider> commandProvider_;
+    std::string metricsCommandId_;
 
+    std::unique_ptr<Metrics::Registry> metrics_;
+    std::unique_ptr<AsyncLogger::AsyncLogger> asyncLogger_;
+    std::unique_ptr<Scheduler::Scheduler> scheduler_;
+    std::unique_ptr<WorkerPool::WorkerPool> workerPool_;
+    std::unique_ptr<HttpClientPool::HttpClientPool> httpClientPool_;
+    std::unique_ptr<Snapshot::SnapshotProvider> snapshotProvider_;
+    std::unique_ptr<TagUpdateQueue::TagUpdateQueue> tagUpdateQueue_;
+    std::unique_ptr<DiskCache::DiskCache> diskCache_;
+    std::unique_ptr<SharedCache::SharedCache> sharedCache_;
     std::unique_ptr<GateAssigner::GateAssigner> gateAssigner_;
     std::unique_ptr<OceanicClearance::OceanicClearance> oceanicClearance_;
 };
\ No newline at end of file
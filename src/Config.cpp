@@ -0,0 +1,95 @@
+// Config.cpp
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+#include <stdexcept>
+#include <toml.hpp>
+#include "Config.h"
+
+namespace Config
+{
+    namespace
+    {
+        // Integer or float value of table.key, 0 when absent
+        double findNumber(const toml::value &data, const std::string &table, const std::string &key)
+        {
+            if (!data.contains(table) || !data.at(table).is_table() || !data.at(table).contains(key))
+            {
+                return 0;
+            }
+            const toml::value &value = data.at(table).at(key);
+            if (value.is_integer())
+            {
+                return static_cast<double>(value.as_integer());
+            }
+            if (value.is_floating())
+            {
+                return value.as_floating();
+            }
+            throw std::runtime_error(table + "." + key + " must be a number");
+        }
+    }
+
+    std::filesystem::path getPluginDirectory(void)
+    {
+#ifdef _WIN32
+        HMODULE module = nullptr;
+        if (GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                reinterpret_cast<LPCWSTR>(&getPluginDirectory), &module))
+        {
+            wchar_t path[MAX_PATH];
+            DWORD length = GetModuleFileNameW(module, path, MAX_PATH);
+            if (length > 0 && length < MAX_PATH)
+            {
+                return std::filesystem::path(path).parent_path();
+            }
+        }
+#else
+        Dl_info info;
+        if (dladdr(reinterpret_cast<void *>(&getPluginDirectory), &info) && info.dli_fname)
+        {
+            return std::filesystem::path(info.dli_fname).parent_path();
+        }
+#endif
+        return std::filesystem::current_path();
+    }
+
+    Config loadConfig(PluginSDK::Logger::LoggerAPI &logger)
+    {
+        Config config;
+        std::filesystem::path path = getPluginDirectory() / CONFIG_FILE_NAME;
+        std::error_code error;
+        if (!std::filesystem::exists(path, error))
+        {
+            logger.info("No " + CONFIG_FILE_NAME + " found, using defaults");
+            return config;
+        }
+
+        try {
+            toml::value data = toml::parse(path.string());
+            config.oceanicDestinations = toml::find_or<std::vector<std::string>>(data, "oceanic", "destinations", std::vector<std::string>());
+            config.gateAssignerApiBase = toml::find_or<std::string>(data, "api", "gate_assigner", std::string());
+            config.nattrakApiBase = toml::find_or<std::string>(data, "api", "nattrak", std::string());
+            config.gatePollingIntervalSec = static_cast<int>(findNumber(data, "gate", "polling_interval_sec"));
+            config.standApiRequestsPerMinute = findNumber(data, "gate", "requests_per_minute");
+            config.standApiBurst = findNumber(data, "gate", "burst");
+            config.gateMaxConcurrentRequests = static_cast<int>(findNumber(data, "gate", "max_concurrent_requests"));
+            config.nattrakMinIntervalSec = static_cast<int>(findNumber(data, "nattrak", "min_interval_sec"));
+            config.nattrakMaxIntervalSec = static_cast<int>(findNumber(data, "nattrak", "max_interval_sec"));
+            config.nattrakRequestsPerMinute = findNumber(data, "nattrak", "requests_per_minute");
+            config.oceanicEvaluationThreads = static_cast<int>(findNumber(data, "oceanic", "evaluation_threads"));
+            config.logLevels = toml::find_or<std::map<std::string, std::string>>(data, "logging", std::map<std::string, std::string>());
+        }
+        catch (const std::exception &err)
+        {
+            logger.error("Failed to parse " + path.string() + ": " + std::string(err.what()));
+            return Config();
+        }
+
+        logger.info("Loaded configuration from " + path.string());
+        return config;
+    }
+}
@@ -0,0 +1,39 @@
+// Config.h
+#pragma once
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+#include <NeoRadarSDK/SDK.h>
+
+namespace Config
+{
+    const std::string CONFIG_FILE_NAME = "CoFrance.toml"; // Looked up next to the plugin library
+
+    // User settings, every field keeps its default when absent from the file
+    struct Config
+    {
+        // Extra oceanic destination rules: first letters, prefixes or full ICAO codes
+        std::vector<std::string> oceanicDestinations;
+
+        // API base URLs, empty for the built-in ones. Lets a replay run target local stand-in servers.
+        std::string gateAssignerApiBase;
+        std::string nattrakApiBase;
+
+        // Polling intervals and request budgets, 0 for the built-in ones
+        int gatePollingIntervalSec = 0;
+        double standApiRequestsPerMinute = 0;
+        double standApiBurst = 0;
+        int gateMaxConcurrentRequests = 0; // Stand queries in flight at the same time
+        int nattrakMinIntervalSec = 0;
+        int nattrakMaxIntervalSec = 0;
+        double nattrakRequestsPerMinute = 0;
+        int oceanicEvaluationThreads = 0; // Threads evaluating the flags of a full pass, 0 for one per core
+
+        // Log level per category ("default", "general", "gate", "oceanic"), e.g. gate = "debug"
+        std::map<std::string, std::string> logLevels;
+    };
+
+    std::filesystem::path getPluginDirectory(void);
+    Config loadConfig(PluginSDK::Logger::LoggerAPI &logger);
+}
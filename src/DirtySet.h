@@ -0,0 +1,38 @@
+// DirtySet.h
+#pragma once
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+namespace DirtySet
+{
+    // Callsigns changed since the last drain. Filled from the SDK event thread,
+    // drained by the module jobs on the scheduler and worker pool threads.
+    class DirtySet
+    {
+        public:
+            void mark(const std::string &callsign)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                callsigns_.insert(callsign);
+            }
+
+            std::unordered_set<std::string> drain(void)
+            {
+                std::unordered_set<std::string> drained;
+                std::lock_guard<std::mutex> lock(mutex_);
+                drained.swap(callsigns_);
+                return drained;
+            }
+
+            void clear(void)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                callsigns_.clear();
+            }
+
+        private:
+            std::mutex mutex_;
+            std::unordered_set<std::string> callsigns_;
+    };
+}
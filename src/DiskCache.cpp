@@ -0,0 +1,173 @@
+// DiskCache.cpp
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "DiskCache.h"
+
+namespace DiskCache
+{
+    namespace
+    {
+        const char MAGIC[4] = {'C', 'F', 'R', 'C'};
+        const uint32_t MAX_FIELD_LENGTH = 4096; // Anything longer means the data is corrupt
+
+        template <typename T>
+        void appendValue(std::string &buffer, T value)
+        {
+            buffer.append(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+
+        template <typename T>
+        bool takeValue(std::string_view &buffer, T &value)
+        {
+            if (buffer.size() < sizeof(value))
+            {
+                return false;
+            }
+            std::memcpy(&value, buffer.data(), sizeof(value));
+            buffer.remove_prefix(sizeof(value));
+            return true;
+        }
+    }
+
+    std::string encodeRecords(const std::vector<Record> &records)
+    {
+        std::string buffer;
+        appendValue<uint32_t>(buffer, static_cast<uint32_t>(records.size()));
+        for (const auto &record : records)
+        {
+            appendValue<uint16_t>(buffer, static_cast<uint16_t>(record.size()));
+            for (const auto &field : record)
+            {
+                appendValue<uint32_t>(buffer, static_cast<uint32_t>(field.size()));
+                buffer.append(field);
+            }
+        }
+        return buffer;
+    }
+
+    std::optional<std::vector<Record>> decodeRecords(std::string_view buffer)
+    {
+        uint32_t recordCount = 0;
+        if (!takeValue(buffer, recordCount))
+        {
+            return std::nullopt;
+        }
+
+        std::vector<Record> records;
+        records.reserve(std::min<size_t>(recordCount, buffer.size()));
+        for (uint32_t i = 0; i < recordCount; i++)
+        {
+            uint16_t fieldCount = 0;
+            if (!takeValue(buffer, fieldCount))
+            {
+                return std::nullopt;
+            }
+            Record &record = records.emplace_back();
+            record.reserve(fieldCount);
+            for (uint16_t j = 0; j < fieldCount; j++)
+            {
+                uint32_t length = 0;
+                if (!takeValue(buffer, length) || length > MAX_FIELD_LENGTH || length > buffer.size())
+                {
+                    return std::nullopt;
+                }
+                record.emplace_back(buffer.substr(0, length));
+                buffer.remove_prefix(length);
+            }
+        }
+
+        // Bytes past the last record mean the count or a length is wrong
+        if (!buffer.empty())
+        {
+            return std::nullopt;
+        }
+        return records;
+    }
+
+    DiskCache::DiskCache(std::filesystem::path directory, AsyncLogger::AsyncLogger &logger)
+        : directory_(std::move(directory)),
+          logger_(logger)
+    {
+    }
+
+    std::filesystem::path DiskCache::sectionPath(const std::string &section) const
+    {
+        return directory_ / (section + ".cache");
+    }
+
+    void DiskCache::save(const std::string &section, const std::vector<Record> &records)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(directory_, error);
+        std::filesystem::path path = sectionPath(section);
+        std::filesystem::path temporaryPath = path;
+        temporaryPath += ".tmp";
+
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file)
+            {
+                logger_.warning(AsyncLogger::Category::General, "Failed to write cache {}", temporaryPath.string());
+                return;
+            }
+
+            std::string header(MAGIC, sizeof(MAGIC));
+            appendValue<uint32_t>(header, CACHE_FORMAT_VERSION);
+            appendValue<int64_t>(header, std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+            std::string payload = encodeRecords(records);
+            file.write(header.data(), header.size());
+            file.write(payload.data(), payload.size());
+            if (!file)
+            {
+                logger_.warning(AsyncLogger::Category::General, "Failed to write cache {}", temporaryPath.string());
+                return;
+            }
+        }
+
+        std::filesystem::rename(temporaryPath, path, error);
+        if (error)
+        {
+            logger_.warning(AsyncLogger::Category::General, "Failed to replace cache {}: {}", path.string(), error.message());
+        }
+    }
+
+    std::optional<std::vector<Record>> DiskCache::load(const std::string &section, std::chrono::seconds maxAge)
+    {
+        std::ifstream file(sectionPath(section), std::ios::binary);
+        if (!file)
+        {
+            return std::nullopt;
+        }
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::string_view buffer = content;
+
+        uint32_t version = 0;
+        int64_t savedAt = 0;
+        if (!buffer.starts_with(std::string_view(MAGIC, sizeof(MAGIC))))
+        {
+            logger_.warning(AsyncLogger::Category::General, "Ignoring unreadable cache {}", sectionPath(section).string());
+            return std::nullopt;
+        }
+        buffer.remove_prefix(sizeof(MAGIC));
+        if (!takeValue(buffer, version) || version != CACHE_FORMAT_VERSION || !takeValue(buffer, savedAt))
+        {
+            logger_.warning(AsyncLogger::Category::General, "Ignoring unreadable cache {}", sectionPath(section).string());
+            return std::nullopt;
+        }
+
+        auto now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        if (now - savedAt > maxAge.count())
+        {
+            return std::nullopt;
+        }
+
+        auto records = decodeRecords(buffer);
+        if (!records)
+        {
+            logger_.warning(AsyncLogger::Category::General, "Ignoring unreadable cache {}", sectionPath(section).string());
+        }
+        return records;
+    }
+}
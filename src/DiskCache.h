@@ -0,0 +1,42 @@
+// DiskCache.h
+#pragma once
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <NeoRadarSDK/SDK.h>
+#include "AsyncLogger.h"
+
+namespace DiskCache
+{
+    const std::string CACHE_DIRECTORY = "cache"; // Under the plugin directory
+    const uint32_t CACHE_FORMAT_VERSION = 1;
+
+    using Record = std::vector<std::string>;
+
+    // Record list as stored in a section, also used by the shared memory cache
+    std::string encodeRecords(const std::vector<Record> &records);
+    std::optional<std::vector<Record>> decodeRecords(std::string_view buffer);
+
+    // Named sections of string records kept in small binary files, so modules can serve
+    // their last known data right after a start or reconnect. Each section is written
+    // to a temporary file then renamed, a reader never sees half a section.
+    class DiskCache
+    {
+        public:
+            DiskCache(std::filesystem::path directory, AsyncLogger::AsyncLogger &logger);
+
+            void save(const std::string &section, const std::vector<Record> &records);
+
+            // Records of a section saved less than maxAge ago
+            std::optional<std::vector<Record>> load(const std::string &section, std::chrono::seconds maxAge);
+
+        private:
+            std::filesystem::path directory_;
+            AsyncLogger::AsyncLogger &logger_;
+
+            std::filesystem::path sectionPath(const std::string &section) const;
+    };
+}
@@ -1,21 +1,59 @@
 // GateAssigner.cpp
-#include <numeric>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <unordered_set>
 #include "GateAssigner.h"
 
 namespace GateAssigner
 {
     GateAssigner::GateAssigner(
-        PluginSDK::Aircraft::AircraftAPI &aircraftAPI,
-        PluginSDK::Flightplan::FlightplanAPI &flightplanAPI,
+        Snapshot::SnapshotProvider &snapshotProvider,
         PluginSDK::Tag::TagAPI &tagAPI,
-        PluginSDK::Logger::LoggerAPI &logger
-    ) : aircraftAPI_(aircraftAPI),
-        flightplanAPI_(flightplanAPI),
+        TagUpdateQueue::TagUpdateQueue &tagUpdateQueue,
+        AsyncLogger::AsyncLogger &logger,
+        HttpClientPool::HttpClientPool &httpClientPool,
+        Scheduler::Scheduler &scheduler,
+        WorkerPool::WorkerPool &workerPool,
+        const Config::Config &config,
+        Metrics::Registry &metrics,
+        DiskCache::DiskCache &diskCache,
+        SharedCache::SharedCache &sharedCache
+    ) : snapshotProvider_(snapshotProvider),
         tagAPI_(tagAPI),
-        logger_(logger)
+        tagUpdateQueue_(tagUpdateQueue),
+        logger_(logger),
+        httpClientPool_(httpClientPool),
+        scheduler_(scheduler),
+        workerPool_(workerPool),
+        diskCache_(diskCache),
+        sharedCache_(sharedCache),
+        apiBase_(config.gateAssignerApiBase.empty() ? GATE_ASSIGNER_API_BASE : config.gateAssignerApiBase),
+        cycleDuration_(metrics.histogram("gate.cycle_us")),
+        airportsEndpoint_(metrics, "http.stand_airports"),
+        standQueryEndpoint_(metrics, "http.stand_query"),
+        standBatchEndpoint_(metrics, "http.stand_query_batch"),
+        parseFailures_(metrics.counter("gate.parse_failures")),
+        tagUpdates_(metrics.counter("gate.tag_updates")),
+        cacheHits_(metrics.counter("gate.cache.hits")),
+        cacheMisses_(metrics.counter("gate.cache.misses")),
+        distanceChecks_(metrics.counter("gate.distance_checks")),
+        cacheSize_(metrics.gauge("gate.cache.size")),
+        localAllocations_(metrics.counter("gate.local.allocations")),
+        localOverrides_(metrics.counter("gate.local.overrides")),
+        localAllocationDuration_(metrics.histogram("gate.local.allocation_us")),
+        batchedQueries_(metrics.counter("gate.batched_queries")),
+        standApiBreaker_("GateAssigner API", logger, metrics),
+        standApiLimiter_("GateAssigner API",
+            config.standApiRequestsPerMinute > 0 ? config.standApiRequestsPerMinute : STAND_API_REQUESTS_PER_MINUTE,
+            config.standApiBurst > 0 ? config.standApiBurst : STAND_API_BURST,
+            logger, metrics),
+        pollingInterval_(config.gatePollingIntervalSec > 0 ? config.gatePollingIntervalSec : POLLING_INTERVAL_SEC),
+        standAllocator_(logger),
+        maxConcurrentRequests_(config.gateMaxConcurrentRequests > 0 ? static_cast<size_t>(config.gateMaxConcurrentRequests) : MAX_CONCURRENT_REQUESTS)
     {
 
-        logger_.info("Initializing GateAssigner");
+        logger_.info(AsyncLogger::Category::Gate, "Initializing GateAssigner");
     
         // Initialize the tag item for gate assignment
         PluginSDK::Tag::TagItemDefinition tagDefinition;
@@ -23,135 +61,684 @@ namespace GateAssigner
         tagDefinition.defaultValue = "--";
         tagDefinition.allowedActions = {};
         gateTagId_ = tagAPI_.getInterface()->RegisterTagItem(tagDefinition);
+
+        std::filesystem::path standDataPath = Config::getPluginDirectory() / StandAllocator::STAND_DATA_FILE_NAME;
+        std::error_code error;
+        if (std::filesystem::exists(standDataPath, error))
+        {
+            standAllocator_.load(standDataPath);
+        }
         
-        logger_.info("GateAssigner initialized successfully");
+        logger_.info(AsyncLogger::Category::Gate, "GateAssigner initialized successfully");
     }
 
     void GateAssigner::startPoller(void)
     {
-        if (!poolerRunning_)
+        if (!pollerRunning_.exchange(true))
         {
-            poolerRunning_ = true;
-            pollerThread_ = std::thread(&GateAssigner::pollerThread, this);
-            logger_.info("GateAssigner poller started");
+            nextChecks_.clear();
+            dirtyCallsigns_.clear();
+            restoreFromDiskCache();
+            pollerJob_ = scheduler_.addBlockingJob("GateAssigner", pollingInterval_, POLLING_JITTER, workerPool_,
+                [this](const std::atomic<bool> &cancelled) { poll(cancelled); });
+            logger_.info(AsyncLogger::Category::Gate, "GateAssigner poller started");
         }
     }
 
     void GateAssigner::stopPoller(void)
     {
-        if (poolerRunning_)
+        if (pollerRunning_.exchange(false))
+        {
+            auto stopStart = std::chrono::steady_clock::now();
+            scheduler_.cancelJob(pollerJob_);
+            sharedCache_.releaseFetcher(SharedCache::Section::GateStands);
+            auto stopDuration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - stopStart);
+            logger_.info(AsyncLogger::Category::Gate, "GateAssigner poller stopped in {} ms", stopDuration.count());
+        }
+    }
+
+    std::chrono::milliseconds GateAssigner::snapshotMaxAge(const Config::Config &config)
+    {
+        return std::chrono::seconds(config.gatePollingIntervalSec > 0 ? config.gatePollingIntervalSec : POLLING_INTERVAL_SEC) + POLLING_JITTER;
+    }
+
+    void GateAssigner::markDirty(const std::string &callsign)
+    {
+        if (pollerRunning_)
+        {
+            dirtyCallsigns_.mark(callsign);
+        }
+    }
+
+    void GateAssigner::poll(const std::atomic<bool> &cancelled)
+    {
+        Metrics::ScopedTimer cycleTimer(cycleDuration_);
+
+        // Only one instance of the host queries the API, elected on the stands section, the others follow what it shares
+        bool fetcher = sharedCache_.acquireFetcher(SharedCache::Section::GateStands);
+
+        // Get the list of supported airports, retried on the next run until the API answers
+        if (!fetcher)
+        {
+            auto airports = sharedCache_.readIfNewer(SharedCache::Section::GateAirports, sharedAirportsSequence_, AIRPORTS_CACHE_MAX_AGE);
+            if (airports && !airports->empty())
+            {
+                setSupportedAirports(std::move(airports->front()));
+            }
+        }
+        else if (supportedAirports_.empty() || std::chrono::steady_clock::now() - supportedAirportsRefreshedAt_ > AIRPORTS_REFRESH_INTERVAL)
+        {
+            refreshSupportedAirports();
+        }
+        if (supportedAirports_.empty())
+        {
+            logger_.warning(AsyncLogger::Category::Gate, "No supported airports found");
+            return;
+        }
+        if (fetcher)
+        {
+            readSharedRequests();
+        }
+
+        // Changed flight plans skip their scheduled check. The snapshot is taken afterwards,
+        // so it already shows the change.
+        for (const auto &callsign : dirtyCallsigns_.drain())
+        {
+            nextChecks_.erase(callsign);
+        }
+
+        // Every gate tick renews the snapshot shared with the other modules
+        auto snapshot = snapshotProvider_.take();
+        auto now = std::chrono::steady_clock::now();
+        const auto &flightplans = snapshot->flightplans();
+        if (!fetcher)
+        {
+            mergeSharedStands(*snapshot);
+        }
+        std::vector<GateRequest> pendingRequests;
+        for (const auto &flightplan : flightplans)
+        {
+            // Forget the previous stand as soon as the flight plan changes
+            auto cached = gateCache_.find(flightplan.callsign);
+            if (cached != gateCache_.end() && !cached->second.matches(flightplan))
+            {
+                gateCache_.erase(cached);
+                cached = gateCache_.end();
+                gateCacheChanged_ = true;
+                nextChecks_.erase(flightplan.callsign);
+                standAllocator_.release(flightplan.callsign);
+            }
+
+            if (!supportedAirportSet_.contains(flightplan.destination))
+            {
+                continue;
+            }
+
+            if (cached != gateCache_.end())
+            {
+                // Stands restored from disk or kept across a reconnect are shown again
+                if (!cached->second.published)
+                {
+                    tagUpdateQueue_.push(gateTagId_, flightplan.callsign, cached->second.gate);
+                    tagUpdates_.add();
+                    cached->second.published = true;
+                }
+                // Local stands keep asking the API on the usual schedule
+                if (!cached->second.local)
+                {
+                    cacheHits_.add();
+                    continue;
+                }
+            }
+
+            auto nextCheck = nextChecks_.find(flightplan.callsign);
+            if (nextCheck != nextChecks_.end() && now < nextCheck->second)
+            {
+                continue;
+            }
+
+            distanceChecks_.add();
+            auto distanceToDestination = snapshot->getDistanceToDestination(flightplan.callsign);
+            if (!distanceToDestination)
+            {
+                nextChecks_[flightplan.callsign] = now + MAX_CHECK_INTERVAL;
+                continue;
+            }
+
+            // Time until the aircraft is STAND_LOOKAHEAD away from the threshold, at its current ground speed
+            const auto *aircraft = snapshot->getAircraft(flightplan.callsign);
+            int groundSpeed = aircraft ? aircraft->position.groundSpeed : 0;
+            double secondsToLookahead = std::numeric_limits<double>::infinity();
+            if (groundSpeed > 0)
+            {
+                secondsToLookahead = (*distanceToDestination - MAX_DISTANCE_TO_DESTINATION) / groundSpeed * 3600.0 - STAND_LOOKAHEAD.count();
+            }
+
+            if (*distanceToDestination < MAX_DISTANCE_TO_DESTINATION || secondsToLookahead <= 0)
+            {
+                cacheMisses_.add();
+                auto timeToThreshold = groundSpeed > 0 ? std::chrono::duration<double>(*distanceToDestination / groundSpeed * 3600.0) : std::chrono::duration<double>(0);
+                GateRequest request{flightplan.callsign, flightplan.origin, flightplan.destination, flightplan.wakeCategory,
+                    now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeToThreshold) + StandAllocator::TAXI_IN_TIME};
+                if (fetcher && cached == gateCache_.end())
+                {
+                    allocateLocalStand(request);
+                }
+                pendingRequests.push_back(std::move(request));
+                nextChecks_[flightplan.callsign] = now + REQUEST_RETRY_INTERVAL;
+            }
+            else
+            {
+                nextChecks_[flightplan.callsign] = nextCheckTime(now, secondsToLookahead);
+            }
+        }
+
+        // Arrivals only followers see are queried with the others and kept while they ask for them
+        std::unordered_set<std::string> sharedCallsigns;
+        if (fetcher)
+        {
+            auto unixNow = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            for (const auto &sharedRequest : sharedRequests_)
+            {
+                const GateRequest &request = sharedRequest.request;
+                if (unixNow - sharedRequest.requestedAt > SHARED_REQUEST_MAX_AGE.count() || snapshot->getFlightplan(request.callsign)
+                    || !supportedAirportSet_.contains(request.destination) || !sharedCallsigns.insert(request.callsign).second)
+                {
+                    continue;
+                }
+
+                auto cached = gateCache_.find(request.callsign);
+                if (cached != gateCache_.end() && !cached->second.matches(request))
+                {
+                    gateCache_.erase(cached);
+                    cached = gateCache_.end();
+                    gateCacheChanged_ = true;
+                    nextChecks_.erase(request.callsign);
+                    standAllocator_.release(request.callsign);
+                }
+                if (cached != gateCache_.end() && !cached->second.local)
+                {
+                    continue;
+                }
+                auto nextCheck = nextChecks_.find(request.callsign);
+                if (nextCheck != nextChecks_.end() && now < nextCheck->second)
+                {
+                    continue;
+                }
+
+                if (cached == gateCache_.end())
+                {
+                    allocateLocalStand(request);
+                }
+                pendingRequests.push_back(request);
+                nextChecks_[request.callsign] = now + REQUEST_RETRY_INTERVAL;
+            }
+        }
+        else if (!pendingRequests.empty())
+        {
+            shareRequests(pendingRequests);
+        }
+
+        // Query the stands concurrently, tags are updated as the answers arrive
+        if (fetcher)
+        {
+            requestGates(pendingRequests, cancelled);
+        }
+
+        // Drop the stands of aircraft that are gone
+        auto gone = [&snapshot, &sharedCallsigns](const std::string &callsign)
+        {
+            return !snapshot->getFlightplan(callsign) && !sharedCallsigns.contains(callsign);
+        };
+        std::erase_if(nextChecks_, [&gone](const auto &entry) { return gone(entry.first); });
+        std::erase_if(bumpedCallsigns_, gone);
+        for (auto it = gateCache_.begin(); it != gateCache_.end();)
+        {
+            if (!gone(it->first))
+            {
+                ++it;
+                continue;
+            }
+            standAllocator_.release(it->first);
+            it = gateCache_.erase(it);
+            gateCacheChanged_ = true;
+        }
+        cacheSize_.set(static_cast<int64_t>(gateCache_.size()));
+        if (gateCacheChanged_ && fetcher)
+        {
+            saveStands();
+        }
+        gateCacheChanged_ = false;
+        logger_.debug(AsyncLogger::Category::Gate, "Gate cache: {} entries, {} hits, {} misses", gateCache_.size(), cacheHits_.value(), cacheMisses_.value());
+    }
+
+    std::chrono::steady_clock::time_point GateAssigner::nextCheckTime(std::chrono::steady_clock::time_point now, double secondsToLookahead)
+    {
+        // Half the remaining time, so a speed change is caught before the aircraft gets there
+        double delay = std::clamp(secondsToLookahead / 2,
+            static_cast<double>(MIN_CHECK_INTERVAL.count()), static_cast<double>(MAX_CHECK_INTERVAL.count()));
+        return now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(delay));
+    }
+
+    void GateAssigner::requestGates(const std::vector<GateRequest> &requests, const std::atomic<bool> &cancelled)
+    {
+        if (requests.empty())
+        {
+            return;
+        }
+
+        // One query per MAX_BATCH_SIZE arrivals when the API supports it
+        size_t firstUnbatched = 0;
+        while (batchSupported_ && firstUnbatched < requests.size() && !cancelled)
+        {
+            std::span<const GateRequest> batch(requests.data() + firstUnbatched, std::min(MAX_BATCH_SIZE, requests.size() - firstUnbatched));
+            auto stands = assignGates(batch);
+            if (!stands)
+            {
+                if (batchSupported_)
+                {
+                    // Failed for another reason, the circuit breaker and the retry schedule take it from there
+                    return;
+                }
+                break;
+            }
+            for (const auto &request : batch)
+            {
+                auto stand = stands->find(request.callsign);
+                if (stand != stands->end() && !stand->second.empty())
+                {
+                    applyGate(request, stand->second);
+                }
+            }
+            firstUnbatched += batch.size();
+        }
+
+        if (firstUnbatched >= requests.size())
+        {
+            return;
+        }
+        workerPool_.parallelFor(requests.size() - firstUnbatched, maxConcurrentRequests_, [this, &requests, firstUnbatched, &cancelled](size_t i)
+        {
+            // Requests not started yet are skipped as soon as the poller is asked to stop
+            if (cancelled)
+            {
+                return;
+            }
+            const GateRequest &request = requests[firstUnbatched + i];
+            logger_.debug(AsyncLogger::Category::Gate, "Requesting gate for {} from {} to {} with wake category {}", request.callsign, request.origin, request.destination, request.wakeCategory);
+            std::string assignedGate = assignGate(request);
+            if (!assignedGate.empty())
+            {
+                applyGate(request, assignedGate);
+            }
+        });
+    }
+
+    void GateAssigner::applyGate(const GateRequest &request, const std::string &assignedGate)
+    {
+        logger_.debug(AsyncLogger::Category::Gate, "Assigned gate {} to {}", assignedGate, request.callsign);
+        bool tagChanged = true;
         {
-            poolerRunning_ = false;
-            if (pollerThread_.joinable())
+            std::lock_guard<std::mutex> lock(gateCacheMutex_);
+            auto cached = gateCache_.find(request.callsign);
+            if (cached != gateCache_.end() && cached->second.local)
             {
-                pollerThread_.join();
+                tagChanged = cached->second.gate != assignedGate;
+                if (tagChanged)
+                {
+                    localOverrides_.add();
+                }
             }
-            logger_.info("GateAssigner poller stopped");
+            gateCache_[request.callsign] = GateCacheEntry{request.origin, request.destination, request.wakeCategory, assignedGate, true, false};
+            gateCacheChanged_ = true;
+            bumpedCallsigns_.erase(request.callsign);
+
+            // Arrivals whose local stand the API gave away get a new one on the next run
+            for (const auto &bumped : standAllocator_.confirm(request.callsign, request.destination, assignedGate, request.expectedOnBlock))
+            {
+                gateCache_.erase(bumped);
+                bumpedCallsigns_.insert(bumped);
+                dirtyCallsigns_.mark(bumped);
+            }
+        }
+        if (tagChanged)
+        {
+            tagUpdateQueue_.push(gateTagId_, request.callsign, assignedGate);
+            tagUpdates_.add();
+        }
+    }
+
+    void GateAssigner::allocateLocalStand(const GateRequest &request)
+    {
+        std::optional<std::string> stand;
+        {
+            Metrics::ScopedTimer allocationTimer(localAllocationDuration_);
+            stand = standAllocator_.allocate(request.callsign, request.destination, request.origin, request.wakeCategory, request.expectedOnBlock);
+        }
+        bool bumped = bumpedCallsigns_.erase(request.callsign) > 0;
+        if (!stand)
+        {
+            // The stand shown went to another arrival and none is left, better nothing than a taken stand
+            if (bumped)
+            {
+                tagUpdateQueue_.push(gateTagId_, request.callsign, "");
+                tagUpdates_.add();
+            }
+            return;
+        }
+        logger_.debug(AsyncLogger::Category::Gate, "Allocated local stand {} to {}", *stand, request.callsign);
+        localAllocations_.add();
+        gateCache_[request.callsign] = GateCacheEntry{request.origin, request.destination, request.wakeCategory, *stand, true, true};
+        gateCacheChanged_ = true;
+        tagUpdateQueue_.push(gateTagId_, request.callsign, *stand);
+        tagUpdates_.add();
+    }
+
+    void GateAssigner::refreshSupportedAirports(void)
+    {
+        std::vector<std::string> supportedAirports = getSupportedAirport();
+        if (supportedAirports.empty())
+        {
+            // Keep serving the previous list
+            return;
+        }
+
+        supportedAirportsRefreshedAt_ = std::chrono::steady_clock::now();
+        if (supportedAirports != supportedAirports_)
+        {
+            setSupportedAirports(std::move(supportedAirports));
+            diskCache_.save(AIRPORTS_CACHE_SECTION, {supportedAirports_});
         }
+        sharedCache_.publish(SharedCache::Section::GateAirports, {supportedAirports_});
     }
 
-    void GateAssigner::pollerThread(void)
+    void GateAssigner::setSupportedAirports(std::vector<std::string> supportedAirports)
     {
-        int counter_sec = 0;
+        if (supportedAirports == supportedAirports_)
+        {
+            return;
+        }
+        supportedAirports_ = std::move(supportedAirports);
+        supportedAirportSet_ = std::unordered_set<std::string>(supportedAirports_.begin(), supportedAirports_.end());
+        if (logger_.enabled(AsyncLogger::Category::Gate, AsyncLogger::Level::Info))
+        {
+            std::string airportList;
+            for (const auto &airport : supportedAirports_)
+            {
+                airportList += (airportList.empty() ? "" : ", ") + airport;
+            }
+            logger_.info(AsyncLogger::Category::Gate, "Supported airports: {}", std::move(airportList));
+        }
+    }
 
-        // Get the list of supported airports
-        supportedAirports_ = getSupportedAirport();
+    void GateAssigner::restoreFromDiskCache(void)
+    {
         if (supportedAirports_.empty())
         {
-            logger_.warning("No supported airports found");
+            auto airports = diskCache_.load(AIRPORTS_CACHE_SECTION, AIRPORTS_CACHE_MAX_AGE);
+            if (airports && !airports->empty())
+            {
+                logger_.info(AsyncLogger::Category::Gate, "Restored {} supported airports from cache", airports->front().size());
+                setSupportedAirports(std::move(airports->front()));
+            }
+        }
+
+        // Tags may have been reset while disconnected
+        for (auto &[callsign, entry] : gateCache_)
+        {
+            entry.published = false;
+        }
+
+        auto stands = diskCache_.load(STANDS_CACHE_SECTION, STANDS_CACHE_MAX_AGE);
+        if (stands)
+        {
+            for (const auto &record : *stands)
+            {
+                // Local stands are allocated again, their occupancy is not saved
+                if (record.size() == 6 && record[5] != "local" && gateCache_.try_emplace(record[0], GateCacheEntry{record[1], record[2], record[3], record[4], false, false}).second)
+                {
+                    standAllocator_.confirm(record[0], record[2], record[4], std::chrono::steady_clock::now());
+                }
+            }
+            logger_.info(AsyncLogger::Category::Gate, "Restored {} stand assignments from cache", stands->size());
+        }
+    }
+
+    void GateAssigner::mergeSharedStands(const Snapshot::Snapshot &snapshot)
+    {
+        auto stands = sharedCache_.readIfNewer(SharedCache::Section::GateStands, sharedStandsSequence_, STANDS_CACHE_MAX_AGE);
+        if (!stands)
+        {
             return;
-        }   
-        logger_.info("Supported airports: " + std::accumulate(supportedAirports_.begin(), supportedAirports_.end(), std::string(),
-            [](const std::string &a, const std::string &b) { return a + (a.length() > 0 ? ", " : "") + b; }));
+        }
 
-        // Poller loop
-        while (poolerRunning_)
+        // Stands of flights whose plan differs locally are left for the next publish
+        for (const auto &record : *stands)
         {
-            if (counter_sec % POLLING_INTERVAL_SEC == 0)
+            const auto *flightplan = record.size() == 6 ? snapshot.getFlightplan(record[0]) : nullptr;
+            if (!flightplan)
+            {
+                continue;
+            }
+            GateCacheEntry entry{record[1], record[2], record[3], record[4], false, record[5] == "local"};
+            if (!entry.matches(*flightplan))
+            {
+                continue;
+            }
+            auto cached = gateCache_.find(record[0]);
+            if (cached == gateCache_.end() || cached->second.gate != entry.gate)
             {
-                std::vector<PluginSDK::Flightplan::Flightplan> flightplans = flightplanAPI_.getAll();
-                for (const auto &flightplan : flightplans)
+                if (!entry.local)
                 {
-                    if (std::find(supportedAirports_.begin(), supportedAirports_.end(), flightplan.destination) != supportedAirports_.end())
-                    {
-                        auto distanceToDestination = aircraftAPI_.getDistanceToDestination(flightplan.callsign);
-                        if (distanceToDestination && *distanceToDestination < MAX_DISTANCE_TO_DESTINATION)
-                        {
-#ifdef DEBUG
-                            logger_.info("Requesting gate for " + flightplan.callsign + " from " + flightplan.origin + " to " + flightplan.destination + " with wake category " + flightplan.wakeCategory);
-#endif
-                            std::string assignedGate = assignGate(flightplan.callsign, flightplan.origin, flightplan.destination, flightplan.wakeCategory);
-                            if (!assignedGate.empty())
-                            {
-#ifdef DEBUG
-                                logger_.info("Assigned gate " + assignedGate + " to " + flightplan.callsign);
-#endif
-                                PluginSDK::Tag::TagContext context;
-                                context.callsign = flightplan.callsign;
-                                tagAPI_.getInterface()->UpdateTagValue(gateTagId_, assignedGate, context);
-                            }
-                        }
-                    }
+                    standAllocator_.confirm(record[0], entry.destination, entry.gate, std::chrono::steady_clock::now());
                 }
+                gateCache_.insert_or_assign(record[0], std::move(entry));
             }
-            
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-            counter_sec++;
         }
     }
 
+    void GateAssigner::shareRequests(const std::vector<GateRequest> &requests)
+    {
+        auto unixNow = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        std::unordered_set<std::string> callsigns;
+        for (const auto &request : requests)
+        {
+            callsigns.insert(request.callsign);
+        }
+
+        // Requests of every follower share the section, expired ones are dropped by whoever writes next
+        sharedCache_.update(SharedCache::Section::GateRequests, [&](std::vector<DiskCache::Record> &records)
+        {
+            std::erase_if(records, [&](const DiskCache::Record &record)
+            {
+                auto sharedRequest = fromRecord(record);
+                return !sharedRequest || callsigns.contains(sharedRequest->request.callsign)
+                    || unixNow - sharedRequest->requestedAt > SHARED_REQUEST_MAX_AGE.count();
+            });
+            for (const auto &request : requests)
+            {
+                records.push_back(toRecord({request, unixNow}));
+            }
+        });
+    }
+
+    void GateAssigner::readSharedRequests(void)
+    {
+        auto records = sharedCache_.readIfNewer(SharedCache::Section::GateRequests, sharedRequestsSequence_, SHARED_REQUEST_MAX_AGE);
+        if (!records)
+        {
+            return;
+        }
+
+        sharedRequests_.clear();
+        for (const auto &record : *records)
+        {
+            auto sharedRequest = fromRecord(record);
+            if (sharedRequest)
+            {
+                sharedRequests_.push_back(std::move(*sharedRequest));
+            }
+        }
+    }
+
+    // Steady clocks of two processes need not agree, the expected on-block time travels as Unix time
+    DiskCache::Record GateAssigner::toRecord(const SharedGateRequest &sharedRequest)
+    {
+        const GateRequest &request = sharedRequest.request;
+        auto unixNow = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch());
+        auto onBlock = unixNow + std::chrono::duration_cast<std::chrono::seconds>(request.expectedOnBlock - std::chrono::steady_clock::now());
+        return {request.callsign, request.origin, request.destination, request.wakeCategory, std::to_string(onBlock.count()), std::to_string(sharedRequest.requestedAt)};
+    }
+
+    std::optional<SharedGateRequest> GateAssigner::fromRecord(const DiskCache::Record &record)
+    {
+        if (record.size() != 6)
+        {
+            return std::nullopt;
+        }
+        SharedGateRequest sharedRequest{{record[0], record[1], record[2], record[3], {}}, 0};
+        try {
+            auto unixNow = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch());
+            sharedRequest.request.expectedOnBlock = std::chrono::steady_clock::now() + (std::chrono::seconds(std::stoll(record[4])) - unixNow);
+            sharedRequest.requestedAt = std::stoll(record[5]);
+        }
+        catch (const std::exception &)
+        {
+            return std::nullopt;
+        }
+        return sharedRequest;
+    }
+
+    void GateAssigner::saveStands(void)
+    {
+        std::vector<DiskCache::Record> records;
+        records.reserve(gateCache_.size());
+        for (const auto &[callsign, entry] : gateCache_)
+        {
+            records.push_back({callsign, entry.origin, entry.destination, entry.wakeCategory, entry.gate, entry.local ? "local" : "api"});
+        }
+        diskCache_.save(STANDS_CACHE_SECTION, records);
+        sharedCache_.publish(SharedCache::Section::GateStands, records);
+    }
+
     std::vector<std::string> GateAssigner::getSupportedAirport(void)
     {
-        httplib::Client cli(GATE_ASSIGNER_API_BASE.c_str());
+        if (!standApiBreaker_.allowRequest())
+        {
+            return std::vector<std::string>();
+        }
+        if (!standApiLimiter_.tryAcquire())
+        {
+            standApiBreaker_.abandonProbe();
+            return std::vector<std::string>();
+        }
+
+        auto cli = httpClientPool_.acquire(apiBase_, REQUEST_DEADLINE);
         httplib::Result result;
+        auto requestStart = std::chrono::steady_clock::now();
         try {
-            result = cli.Get(GATE_ASSIGNER_API_AIRPORTS.c_str());
+            result = cli->Get(GATE_ASSIGNER_API_AIRPORTS.c_str());
         }
         catch (const std::exception &e)
         {
-            logger_.error("Failed to connect to GateAssigner API: " + std::string(e.what()));
+            airportsEndpoint_.record(0, std::chrono::steady_clock::now() - requestStart);
+            standApiBreaker_.recordFailure();
+            logger_.error(AsyncLogger::Category::Gate, "Failed to connect to GateAssigner API: {}", e.what());
             return std::vector<std::string>();
         }
+        airportsEndpoint_.record(result ? result->status : 0, std::chrono::steady_clock::now() - requestStart);
+
+        if (!result) {
+            standApiBreaker_.recordFailure();
+            logger_.error(AsyncLogger::Category::Gate, "Failed to connect to GateAssigner API: {}", httplib::to_string(result.error()));
+            return std::vector<std::string>();
+        }
+        standApiLimiter_.recordResponse(result->status, result->get_header_value("Retry-After"));
+        if (CircuitBreaker::CircuitBreaker::isFailureStatus(result->status))
+        {
+            standApiBreaker_.recordFailure();
+        }
+        else
+        {
+            standApiBreaker_.recordSuccess();
+        }
         
         if (result->status != httplib::StatusCode::OK_200) {
-            logger_.error("GateAssigner API returned error: " + std::to_string(result->status));
+            logger_.error(AsyncLogger::Category::Gate, "GateAssigner API returned error: {}", result->status);
             return std::vector<std::string>();
         }
         
         try {
             toml::value tomlResult = toml::parse_str(result->body);
+            bool batchSupported = toml::find_or<bool>(tomlResult, "data", "batch", false);
+            if (batchSupported != batchSupported_)
+            {
+                logger_.info(AsyncLogger::Category::Gate, "GateAssigner API batch queries {}", batchSupported ? "enabled" : "disabled");
+                batchSupported_ = batchSupported;
+            }
             return toml::find<std::vector<std::string>>(tomlResult, "data", "icaos");
         }
         catch (const std::exception &err)
         {
-            logger_.error("Failed to parse TOML: " + std::string(err.what()));
+            parseFailures_.add();
+            logger_.error(AsyncLogger::Category::Gate, "Failed to parse TOML: {}", err.what());
             return std::vector<std::string>();
         }        
         
         return std::vector<std::string>();
     }
 
-    std::string GateAssigner::assignGate(std::string callsign, std::string origin, std::string destination, std::string wakeCategory)
+    std::string GateAssigner::assignGate(const GateRequest &request)
     {
-        httplib::Client cli(GATE_ASSIGNER_API_BASE.c_str());
+        // While the API is down or the budget is spent the cached stands keep being served
+        if (!standApiBreaker_.allowRequest())
+        {
+            return "";
+        }
+        if (!standApiLimiter_.tryAcquire())
+        {
+            standApiBreaker_.abandonProbe();
+            return "";
+        }
+
+        auto cli = httpClientPool_.acquire(apiBase_, REQUEST_DEADLINE);
         httplib::Params params;
-        params.emplace("callsign", callsign);
-        params.emplace("dep", origin);
-        params.emplace("arr", destination);
-        params.emplace("wtc", wakeCategory);
+        params.emplace("callsign", request.callsign);
+        params.emplace("dep", request.origin);
+        params.emplace("arr", request.destination);
+        params.emplace("wtc", request.wakeCategory);
         httplib::Result result;
+        auto requestStart = std::chrono::steady_clock::now();
 
         try {
-            result = cli.Post(GATE_ASSIGNER_API_GATES.c_str(), params);
+            result = cli->Post(GATE_ASSIGNER_API_GATES.c_str(), params);
         }
         catch (const std::exception &e)
         {
-            logger_.error("Failed to connect to GateAssigner API: " + std::string(e.what()));
+            standQueryEndpoint_.record(0, std::chrono::steady_clock::now() - requestStart);
+            standApiBreaker_.recordFailure();
+            logger_.error(AsyncLogger::Category::Gate, "Failed to connect to GateAssigner API: {}", e.what());
             return "";
         }
+        standQueryEndpoint_.record(result ? result->status : 0, std::chrono::steady_clock::now() - requestStart);
+
+        if (!result) {
+            standApiBreaker_.recordFailure();
+            logger_.error(AsyncLogger::Category::Gate, "Failed to connect to GateAssigner API: {}", httplib::to_string(result.error()));
+            return "";
+        }
+        standApiLimiter_.recordResponse(result->status, result->get_header_value("Retry-After"));
+        if (CircuitBreaker::CircuitBreaker::isFailureStatus(result->status))
+        {
+            standApiBreaker_.recordFailure();
+        }
+        else
+        {
+            standApiBreaker_.recordSuccess();
+        }
         
         if (result->status != httplib::StatusCode::OK_200) {
-            logger_.error("GateAssigner API returned error: " + std::to_string(result->status));
+            logger_.error(AsyncLogger::Category::Gate, "GateAssigner API returned error: {}", result->status);
             return "";
         }
 
@@ -161,10 +748,103 @@ namespace GateAssigner
         }
         catch (const std::exception &err)
         {
-            logger_.error("Failed to parse TOML: " + std::string(err.what()));
+            parseFailures_.add();
+            logger_.error(AsyncLogger::Category::Gate, "Failed to parse TOML: {}", err.what());
             return "";
         }
         
         return "";
     }
+
+    std::optional<std::unordered_map<std::string, std::string>> GateAssigner::assignGates(std::span<const GateRequest> requests)
+    {
+        if (!standApiBreaker_.allowRequest())
+        {
+            return std::nullopt;
+        }
+        if (!standApiLimiter_.tryAcquire())
+        {
+            standApiBreaker_.abandonProbe();
+            return std::nullopt;
+        }
+
+        // One "callsign,dep,arr,wtc" field per arrival
+        auto cli = httpClientPool_.acquire(apiBase_, REQUEST_DEADLINE);
+        httplib::Params params;
+        for (const auto &request : requests)
+        {
+            params.emplace("flight", request.callsign + "," + request.origin + "," + request.destination + "," + request.wakeCategory);
+        }
+        httplib::Result result;
+        auto requestStart = std::chrono::steady_clock::now();
+
+        try {
+            result = cli->Post(GATE_ASSIGNER_API_GATES_BATCH.c_str(), params);
+        }
+        catch (const std::exception &e)
+        {
+            standBatchEndpoint_.record(0, std::chrono::steady_clock::now() - requestStart);
+            standApiBreaker_.recordFailure();
+            logger_.error(AsyncLogger::Category::Gate, "Failed to connect to GateAssigner API: {}", e.what());
+            return std::nullopt;
+        }
+        standBatchEndpoint_.record(result ? result->status : 0, std::chrono::steady_clock::now() - requestStart);
+
+        if (!result) {
+            standApiBreaker_.recordFailure();
+            logger_.error(AsyncLogger::Category::Gate, "Failed to connect to GateAssigner API: {}", httplib::to_string(result.error()));
+            return std::nullopt;
+        }
+        if (result->status == httplib::StatusCode::NotFound_404 || result->status == httplib::StatusCode::MethodNotAllowed_405 || result->status == httplib::StatusCode::NotImplemented_501)
+        {
+            // Advertised but not served, back to one query per flight until the next airports refresh
+            standApiBreaker_.recordSuccess();
+            batchSupported_ = false;
+            logger_.warning(AsyncLogger::Category::Gate, "GateAssigner API does not serve batch queries ({}), querying flights one by one", result->status);
+            return std::nullopt;
+        }
+        standApiLimiter_.recordResponse(result->status, result->get_header_value("Retry-After"));
+        if (CircuitBreaker::CircuitBreaker::isFailureStatus(result->status))
+        {
+            standApiBreaker_.recordFailure();
+        }
+        else
+        {
+            standApiBreaker_.recordSuccess();
+        }
+
+        if (result->status != httplib::StatusCode::OK_200) {
+            logger_.error(AsyncLogger::Category::Gate, "GateAssigner API returned error: {}", result->status);
+            return std::nullopt;
+        }
+
+        try {
+            toml::value tomlResult = toml::parse_str(result->body);
+            batchedQueries_.add(requests.size());
+            std::unordered_map<std::string, std::string> stands;
+            if (!tomlResult.contains("data") || !tomlResult.at("data").contains("stands"))
+            {
+                return stands;
+            }
+
+            // Entry by entry, a malformed one only costs its own flight the stand
+            for (const auto &[callsign, stand] : tomlResult.at("data").at("stands").as_table())
+            {
+                if (!stand.is_string())
+                {
+                    parseFailures_.add();
+                    logger_.warning(AsyncLogger::Category::Gate, "Ignoring the stand of {} in the batch answer, not a string", callsign);
+                    continue;
+                }
+                stands.emplace(callsign, stand.as_string());
+            }
+            return stands;
+        }
+        catch (const std::exception &err)
+        {
+            parseFailures_.add();
+            logger_.error(AsyncLogger::Category::Gate, "Failed to parse TOML: {}", err.what());
+            return std::nullopt;
+        }
+    }
 }
\ No newline at end of file
@@ -1,52 +1,212 @@
 // GateAssigner.h
 #pragma once
-#define CPPHTTPLIB_OPENSSL_SUPPORT
-#include <httplib.h>
-#include <thread>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
 #include <toml.hpp>
 #include <NeoRadarSDK/SDK.h>
+#include "AsyncLogger.h"
+#include "CircuitBreaker.h"
+#include "Config.h"
+#include "DirtySet.h"
+#include "DiskCache.h"
+#include "HttpClientPool.h"
+#include "Metrics.h"
+#include "RateLimiter.h"
+#include "Scheduler.h"
+#include "SharedCache.h"
+#include "Snapshot.h"
+#include "StandAllocator.h"
+#include "TagUpdateQueue.h"
+#include "WorkerPool.h"
 
 
 namespace GateAssigner
 {
-    const int POLLING_INTERVAL_SEC = 30; // Polling interval in seconds
+    const int POLLING_INTERVAL_SEC = 5; // Polling interval in seconds, arrivals are only checked when due
+    const std::chrono::milliseconds POLLING_JITTER = std::chrono::seconds(1);
+    const double STAND_API_REQUESTS_PER_MINUTE = 60;
+    const double STAND_API_BURST = 10; // Arrivals reaching the threshold together
     const int MAX_DISTANCE_TO_DESTINATION = 20;
+    const std::chrono::seconds STAND_LOOKAHEAD = std::chrono::seconds(120); // Stand requested this long before MAX_DISTANCE_TO_DESTINATION
+    const std::chrono::seconds MIN_CHECK_INTERVAL = std::chrono::seconds(5);
+    const std::chrono::seconds MAX_CHECK_INTERVAL = std::chrono::minutes(5);
+    const std::chrono::seconds REQUEST_RETRY_INTERVAL = std::chrono::seconds(30); // After a stand query without answer
+    const std::chrono::seconds SHARED_REQUEST_MAX_AGE = REQUEST_RETRY_INTERVAL * 2; // Followers renew their requests on every retry
+    const size_t MAX_CONCURRENT_REQUESTS = 4; // Stand queries in flight at the same time, [gate] max_concurrent_requests
+    const std::chrono::milliseconds REQUEST_DEADLINE = std::chrono::seconds(5); // Per stand query
+    const std::chrono::hours AIRPORTS_REFRESH_INTERVAL = std::chrono::hours(1);
+    const std::chrono::hours AIRPORTS_CACHE_MAX_AGE = std::chrono::hours(24 * 7);
+    const std::chrono::hours STANDS_CACHE_MAX_AGE = std::chrono::hours(3);
+    const std::string AIRPORTS_CACHE_SECTION = "gate_airports";
+    const std::string STANDS_CACHE_SECTION = "gate_stands";
     const std::string GATE_ASSIGNER_TAG = "gate";
     const std::string GATE_ASSIGNER_API_BASE = "http://fire-ops.ew.r.appspot.com";
     const std::string GATE_ASSIGNER_API_AIRPORTS = "/api/cfr/stand";
     const std::string GATE_ASSIGNER_API_GATES = "/api/cfr/stand/query";
+    const std::string GATE_ASSIGNER_API_GATES_BATCH = "/api/cfr/stand/query/batch"; // Offered when the airports answer has data.batch = true
+    const size_t MAX_BATCH_SIZE = 50; // Arrivals per batch query
+
+    // Stand query for a single arrival
+    struct GateRequest
+    {
+        std::string callsign;
+        std::string origin;
+        std::string destination;
+        std::string wakeCategory;
+        std::chrono::steady_clock::time_point expectedOnBlock;
+    };
+
+    // Stand query a follower instance left for the fetcher, for an arrival the fetcher may not see
+    struct SharedGateRequest
+    {
+        GateRequest request;
+        int64_t requestedAt; // Unix time in seconds
+    };
+
+    // Stand assigned to a callsign, valid as long as the flight plan key is unchanged
+    struct GateCacheEntry
+    {
+        std::string origin;
+        std::string destination;
+        std::string wakeCategory;
+        std::string gate;
+        bool published = false; // Tag already shows the stand
+        bool local = false; // Allocated in the plugin, replaced by the API answer
+
+        bool matches(const PluginSDK::Flightplan::Flightplan &flightplan) const
+        {
+            return origin == flightplan.origin && destination == flightplan.destination && wakeCategory == flightplan.wakeCategory;
+        }
+
+        bool matches(const GateRequest &request) const
+        {
+            return origin == request.origin && destination == request.destination && wakeCategory == request.wakeCategory;
+        }
+    };
 
     class GateAssigner
     {
         public:
             GateAssigner(
-                PluginSDK::Aircraft::AircraftAPI &aircraftAPI,
-                PluginSDK::Flightplan::FlightplanAPI &flightplanAPI,
+                Snapshot::SnapshotProvider &snapshotProvider,
                 PluginSDK::Tag::TagAPI &tagAPI,
-                PluginSDK::Logger::LoggerAPI &logger
+                TagUpdateQueue::TagUpdateQueue &tagUpdateQueue,
+                AsyncLogger::AsyncLogger &logger,
+                HttpClientPool::HttpClientPool &httpClientPool,
+                Scheduler::Scheduler &scheduler,
+                WorkerPool::WorkerPool &workerPool,
+                const Config::Config &config,
+                Metrics::Registry &metrics,
+                DiskCache::DiskCache &diskCache,
+                SharedCache::SharedCache &sharedCache
             );
             ~GateAssigner() = default;
 
             void startPoller();
             void stopPoller();
 
+            // The gate tick renews the shared snapshot, the other modules read it until the next tick
+            static std::chrono::milliseconds snapshotMaxAge(const Config::Config &config);
+
+            // Flight plan of a callsign changed, it is checked again on the next run
+            void markDirty(const std::string &callsign);
+
         private:
-            PluginSDK::Aircraft::AircraftAPI &aircraftAPI_;
-            PluginSDK::Flightplan::FlightplanAPI &flightplanAPI_;
+            Snapshot::SnapshotProvider &snapshotProvider_;
             PluginSDK::Tag::TagAPI &tagAPI_;
-            PluginSDK::Logger::LoggerAPI &logger_;
+            TagUpdateQueue::TagUpdateQueue &tagUpdateQueue_;
+            AsyncLogger::AsyncLogger &logger_;
+            HttpClientPool::HttpClientPool &httpClientPool_;
+            Scheduler::Scheduler &scheduler_;
+            WorkerPool::WorkerPool &workerPool_;
+            DiskCache::DiskCache &diskCache_;
+            SharedCache::SharedCache &sharedCache_;
             std::string gateTagId_;
+            std::string apiBase_;
+
+            // Metrics
+            Metrics::Histogram &cycleDuration_;
+            Metrics::EndpointMetrics airportsEndpoint_;
+            Metrics::EndpointMetrics standQueryEndpoint_;
+            Metrics::EndpointMetrics standBatchEndpoint_;
+            Metrics::Counter &parseFailures_;
+            Metrics::Counter &tagUpdates_;
+            Metrics::Counter &cacheHits_;
+            Metrics::Counter &cacheMisses_;
+            Metrics::Counter &distanceChecks_;
+            Metrics::Gauge &cacheSize_;
+            Metrics::Counter &localAllocations_;
+            Metrics::Counter &localOverrides_;
+            Metrics::Histogram &localAllocationDuration_;
+            Metrics::Counter &batchedQueries_;
+
+            // Shared by all calls to the stand API
+            CircuitBreaker::CircuitBreaker standApiBreaker_;
+            RateLimiter::TokenBucket standApiLimiter_;
 
-            // Thread for the poller
-            void pollerThread();
-            std::thread pollerThread_;
-            bool poolerRunning_ = false;
+            // Poller job on the plugin scheduler
+            void poll(const std::atomic<bool> &cancelled);
+            Scheduler::JobId pollerJob_ = 0;
+            std::atomic<bool> pollerRunning_ = false;
+            std::chrono::seconds pollingInterval_;
 
-            // Supported airports from the API
+            // Supported airports from the API, refreshed every AIRPORTS_REFRESH_INTERVAL
             std::vector<std::string> supportedAirports_;
+            std::unordered_set<std::string> supportedAirportSet_;
+            std::chrono::steady_clock::time_point supportedAirportsRefreshedAt_;
             std::vector<std::string> getSupportedAirport(void);
+            void refreshSupportedAirports(void);
+            void setSupportedAirports(std::vector<std::string> supportedAirports);
+
+            // Last known airports and stands, served until the API answers
+            void restoreFromDiskCache(void);
+            void saveStands(void);
+
+            // Airports and stands published by the fetcher instance of the host
+            uint64_t sharedAirportsSequence_ = 0;
+            uint64_t sharedStandsSequence_ = 0;
+            void mergeSharedStands(const Snapshot::Snapshot &snapshot);
+
+            // Followers leave the arrivals due for a stand in a section every instance writes, the
+            // fetcher queries them with its own and shares the answers with the other stands
+            uint64_t sharedRequestsSequence_ = 0;
+            std::vector<SharedGateRequest> sharedRequests_;
+            void shareRequests(const std::vector<GateRequest> &requests);
+            void readSharedRequests(void);
+            static DiskCache::Record toRecord(const SharedGateRequest &sharedRequest);
+            static std::optional<SharedGateRequest> fromRecord(const DiskCache::Record &record);
+
+            // Stands already assigned, keyed by callsign
+            std::unordered_map<std::string, GateCacheEntry> gateCache_;
+            std::mutex gateCacheMutex_;
+            bool gateCacheChanged_ = false;
+
+            // Next time the distance of an arrival without stand is checked, keyed by callsign.
+            // Far away traffic is checked rarely, aircraft nearing the threshold every tick.
+            std::unordered_map<std::string, std::chrono::steady_clock::time_point> nextChecks_;
+            DirtySet::DirtySet dirtyCallsigns_;
+            static std::chrono::steady_clock::time_point nextCheckTime(std::chrono::steady_clock::time_point now, double secondsToLookahead);
+
+            // Stands of the data file, shown right away and reconciled with the API answers
+            StandAllocator::StandAllocator standAllocator_;
+            std::unordered_set<std::string> bumpedCallsigns_; // Local stand given away by the API, tag still shows it
+            void allocateLocalStand(const GateRequest &request);
+
+            // Run the stand queries in batches, or one per flight on the worker pool with at most
+            // maxConcurrentRequests_ in flight
+            void requestGates(const std::vector<GateRequest> &requests, const std::atomic<bool> &cancelled);
+            void applyGate(const GateRequest &request, const std::string &assignedGate);
+            std::atomic<bool> batchSupported_ = false;
+            size_t maxConcurrentRequests_;
 
             // Assign a gate based on flightplan data
-            std::string assignGate(std::string callsign, std::string origin, std::string destination, std::string wakeCategory);
+            std::string assignGate(const GateRequest &request);
+
+            // Stands of several arrivals keyed by callsign, nullopt when the query failed
+            std::optional<std::unordered_map<std::string, std::string>> assignGates(std::span<const GateRequest> requests);
     };
 }
\ No newline at end of file
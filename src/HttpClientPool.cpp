@@ -0,0 +1,74 @@
+// HttpClientPool.cpp
+#include "HttpClientPool.h"
+
+namespace HttpClientPool
+{
+    HttpClientPool::Lease::Lease(HttpClientPool &pool, std::string baseUrl, std::unique_ptr<httplib::Client> client)
+        : pool_(pool),
+          baseUrl_(std::move(baseUrl)),
+          client_(std::move(client))
+    {
+    }
+
+    HttpClientPool::Lease::~Lease()
+    {
+        if (client_)
+        {
+            pool_.release(baseUrl_, std::move(client_));
+        }
+    }
+
+    HttpClientPool::HttpClientPool(Options options) : options_(options)
+    {
+    }
+
+    HttpClientPool::Lease HttpClientPool::acquire(const std::string &baseUrl)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = idleClients_.find(baseUrl);
+            if (it != idleClients_.end() && !it->second.empty())
+            {
+                std::unique_ptr<httplib::Client> client = std::move(it->second.back());
+                it->second.pop_back();
+                return Lease(*this, baseUrl, std::move(client));
+            }
+        }
+
+        // No idle client for this host, open a new one outside the lock
+        return Lease(*this, baseUrl, createClient(baseUrl));
+    }
+
+    HttpClientPool::Lease HttpClientPool::acquire(const std::string &baseUrl, std::chrono::milliseconds deadline)
+    {
+        Lease lease = acquire(baseUrl);
+        lease->set_read_timeout(deadline);
+        lease->set_write_timeout(deadline);
+        return lease;
+    }
+
+    std::unique_ptr<httplib::Client> HttpClientPool::createClient(const std::string &baseUrl) const
+    {
+        // Keep-alive keeps the TCP and TLS session open between requests on the same client
+        auto client = std::make_unique<httplib::Client>(baseUrl);
+        client->set_keep_alive(true);
+        client->set_connection_timeout(options_.connectTimeout);
+        client->set_read_timeout(options_.readTimeout);
+        client->set_write_timeout(options_.writeTimeout);
+        return client;
+    }
+
+    void HttpClientPool::release(const std::string &baseUrl, std::unique_ptr<httplib::Client> client)
+    {
+        // Undo any per-lease deadline before the client is reused
+        client->set_read_timeout(options_.readTimeout);
+        client->set_write_timeout(options_.writeTimeout);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto &idle = idleClients_[baseUrl];
+        if (idle.size() < options_.maxIdleClientsPerHost)
+        {
+            idle.push_back(std::move(client));
+        }
+    }
+}
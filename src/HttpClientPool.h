@@ -0,0 +1,68 @@
+// HttpClientPool.h
+#pragma once
+#include <httplib.h>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace HttpClientPool
+{
+    const std::chrono::milliseconds DEFAULT_CONNECT_TIMEOUT = std::chrono::seconds(5);
+    const std::chrono::milliseconds DEFAULT_READ_TIMEOUT = std::chrono::seconds(10);
+    const std::chrono::milliseconds DEFAULT_WRITE_TIMEOUT = std::chrono::seconds(5);
+    const size_t DEFAULT_MAX_IDLE_CLIENTS_PER_HOST = 4;
+
+    struct Options
+    {
+        std::chrono::milliseconds connectTimeout = DEFAULT_CONNECT_TIMEOUT;
+        std::chrono::milliseconds readTimeout = DEFAULT_READ_TIMEOUT;
+        std::chrono::milliseconds writeTimeout = DEFAULT_WRITE_TIMEOUT;
+        size_t maxIdleClientsPerHost = DEFAULT_MAX_IDLE_CLIENTS_PER_HOST;
+    };
+
+    class HttpClientPool
+    {
+        public:
+            // Exclusive use of a keep-alive client, handed back to the pool on destruction
+            class Lease
+            {
+                public:
+                    Lease(HttpClientPool &pool, std::string baseUrl, std::unique_ptr<httplib::Client> client);
+                    Lease(Lease &&other) noexcept = default;
+                    Lease &operator=(Lease &&other) = delete;
+                    Lease(const Lease &) = delete;
+                    Lease &operator=(const Lease &) = delete;
+                    ~Lease();
+
+                    httplib::Client *operator->() const { return client_.get(); }
+                    httplib::Client &operator*() const { return *client_; }
+
+                private:
+                    HttpClientPool &pool_;
+                    std::string baseUrl_;
+                    std::unique_ptr<httplib::Client> client_;
+            };
+
+            explicit HttpClientPool(Options options = Options());
+            ~HttpClientPool() = default;
+
+            // Borrow a client for the given scheme://host[:port]
+            Lease acquire(const std::string &baseUrl);
+
+            // Same, with read and write deadlines overridden for this lease only
+            Lease acquire(const std::string &baseUrl, std::chrono::milliseconds deadline);
+
+            const Options &options() const { return options_; }
+
+        private:
+            Options options_;
+            std::mutex mutex_;
+            std::unordered_map<std::string, std::vector<std::unique_ptr<httplib::Client>>> idleClients_;
+
+            std::unique_ptr<httplib::Client> createClient(const std::string &baseUrl) const;
+            void release(const std::string &baseUrl, std::unique_ptr<httplib::Client> client);
+    };
+}
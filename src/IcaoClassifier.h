@@ -0,0 +1,113 @@
+// IcaoClassifier.h
+#pragma once
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <string_view>
+
+namespace IcaoClassifier
+{
+    const size_t MAX_PREFIX_RULES = 32; // Prefixes of 2 to 4 letters, on top of the first-letter mask
+
+    // Classifies 4-letter ICAO codes by region: a bitmask of first letters plus explicit
+    // prefixes or codes (e.g. "SP" or "LFVP"). Default rule sets are built at compile time,
+    // extra rules can be added at runtime without allocating.
+    class IcaoClassifier
+    {
+        public:
+            constexpr IcaoClassifier(std::string_view firstLetters, std::initializer_list<std::string_view> prefixes)
+            {
+                for (char letter : firstLetters)
+                {
+                    if (!addRule(std::string_view(&letter, 1)))
+                    {
+                        throw std::invalid_argument("Invalid first letter rule");
+                    }
+                }
+                for (auto prefix : prefixes)
+                {
+                    if (!addRule(prefix))
+                    {
+                        throw std::invalid_argument("Invalid prefix rule");
+                    }
+                }
+            }
+
+            // Add a first letter ("K"), a prefix ("SP") or a full code ("LFVP")
+            constexpr bool addRule(std::string_view rule)
+            {
+                if (rule.empty() || rule.size() > 4)
+                {
+                    return false;
+                }
+                for (char c : rule)
+                {
+                    if (!isLetter(c))
+                    {
+                        return false;
+                    }
+                }
+
+                if (rule.size() == 1)
+                {
+                    letterMask_ |= 1u << (rule[0] - 'A');
+                    return true;
+                }
+                if (prefixCount_ >= MAX_PREFIX_RULES)
+                {
+                    return false;
+                }
+                Prefix &prefix = prefixes_[prefixCount_++];
+                prefix.length = static_cast<uint8_t>(rule.size());
+                for (size_t i = 0; i < rule.size(); i++)
+                {
+                    prefix.letters[i] = rule[i];
+                }
+                return true;
+            }
+
+            // True for a 4-letter upper-case code covered by one of the rules
+            constexpr bool matches(std::string_view icao) const
+            {
+                if (icao.size() != 4 || !isLetter(icao[0]) || !isLetter(icao[1]) || !isLetter(icao[2]) || !isLetter(icao[3]))
+                {
+                    return false;
+                }
+                if (letterMask_ & (1u << (icao[0] - 'A')))
+                {
+                    return true;
+                }
+                for (size_t i = 0; i < prefixCount_; i++)
+                {
+                    const Prefix &prefix = prefixes_[i];
+                    size_t length = 0;
+                    while (length < prefix.length && prefix.letters[length] == icao[length])
+                    {
+                        length++;
+                    }
+                    if (length == prefix.length)
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+        private:
+            struct Prefix
+            {
+                std::array<char, 4> letters{};
+                uint8_t length = 0;
+            };
+
+            uint32_t letterMask_ = 0;
+            std::array<Prefix, MAX_PREFIX_RULES> prefixes_{};
+            size_t prefixCount_ = 0;
+
+            static constexpr bool isLetter(char c)
+            {
+                return c >= 'A' && c <= 'Z';
+            }
+    };
+}
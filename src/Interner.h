@@ -0,0 +1,63 @@
+// Interner.h
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Interner
+{
+    using Id = uint32_t;
+
+    // Small integer ids for strings seen over and over (tag ids, callsigns). Append only:
+    // an id and the string behind it stay valid for the lifetime of the interner, and
+    // looking up a known string does not allocate. Safe to share between threads.
+    class Interner
+    {
+        public:
+            Id intern(std::string_view value)
+            {
+                {
+                    std::shared_lock<std::shared_mutex> lock(mutex_);
+                    auto it = ids_.find(value);
+                    if (it != ids_.end())
+                    {
+                        return it->second;
+                    }
+                }
+                std::unique_lock<std::shared_mutex> lock(mutex_);
+                auto it = ids_.find(value);
+                if (it != ids_.end())
+                {
+                    return it->second;
+                }
+                const std::string &stored = strings_.emplace_back(value);
+                Id id = static_cast<Id>(strings_.size() - 1);
+                ids_.emplace(stored, id);
+                return id;
+            }
+
+            std::optional<Id> find(std::string_view value) const
+            {
+                std::shared_lock<std::shared_mutex> lock(mutex_);
+                auto it = ids_.find(value);
+                return it != ids_.end() ? std::optional(it->second) : std::nullopt;
+            }
+
+            // Reference stays valid, new strings never move the stored ones
+            const std::string &name(Id id) const
+            {
+                std::shared_lock<std::shared_mutex> lock(mutex_);
+                return strings_[id];
+            }
+
+        private:
+            mutable std::shared_mutex mutex_;
+            std::deque<std::string> strings_;
+            std::unordered_map<std::string_view, Id> ids_; // Views into strings_
+    };
+}
@@ -0,0 +1,190 @@
+// Metrics.cpp
+#include <bit>
+#include <cmath>
+#include <fstream>
+#include "Metrics.h"
+
+namespace Metrics
+{
+    void Histogram::record(uint64_t micros)
+    {
+        buckets_[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(micros, std::memory_order_relaxed);
+        uint64_t currentMax = max_.load(std::memory_order_relaxed);
+        while (micros > currentMax && !max_.compare_exchange_weak(currentMax, micros, std::memory_order_relaxed)) {}
+    }
+
+    void Histogram::record(std::chrono::steady_clock::duration duration)
+    {
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        record(static_cast<uint64_t>(std::max<int64_t>(micros, 0)));
+    }
+
+    uint64_t Histogram::mean() const
+    {
+        uint64_t n = count();
+        return n > 0 ? sum_.load(std::memory_order_relaxed) / n : 0;
+    }
+
+    uint64_t Histogram::percentile(double percent) const
+    {
+        uint64_t n = count();
+        if (n == 0)
+        {
+            return 0;
+        }
+
+        uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percent / 100.0 * n)));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; i++)
+        {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= target)
+            {
+                // Upper edge of the bucket, capped by the largest value recorded
+                uint64_t upper = i + 1 < BUCKETS ? bucketLowerBound(i + 1) - 1 : UINT64_MAX;
+                return std::min(upper, max());
+            }
+        }
+        return max();
+    }
+
+    size_t Histogram::bucketIndex(uint64_t value)
+    {
+        if (value < SUB_BUCKETS)
+        {
+            return static_cast<size_t>(value);
+        }
+        int shift = std::bit_width(value) - 1 - SUB_BUCKET_BITS;
+        size_t subBucket = static_cast<size_t>(value >> shift) & (SUB_BUCKETS - 1);
+        return (shift + 1) * SUB_BUCKETS + subBucket;
+    }
+
+    uint64_t Histogram::bucketLowerBound(size_t index)
+    {
+        if (index < SUB_BUCKETS)
+        {
+            return index;
+        }
+        size_t shift = index / SUB_BUCKETS - 1;
+        return (SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    }
+
+    EndpointMetrics::EndpointMetrics(Registry &registry, const std::string &name)
+        : latency_(registry.histogram(name + ".latency_us")),
+          status2xx_(registry.counter(name + ".status.2xx")),
+          status3xx_(registry.counter(name + ".status.3xx")),
+          status4xx_(registry.counter(name + ".status.4xx")),
+          status5xx_(registry.counter(name + ".status.5xx")),
+          failures_(registry.counter(name + ".failures"))
+    {
+    }
+
+    void EndpointMetrics::record(int status, std::chrono::steady_clock::duration duration)
+    {
+        latency_.record(duration);
+        switch (status / 100)
+        {
+            case 2: status2xx_.add(); break;
+            case 3: status3xx_.add(); break;
+            case 4: status4xx_.add(); break;
+            case 5: status5xx_.add(); break;
+            default: failures_.add(); break;
+        }
+    }
+
+    Counter &Registry::counter(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto &metric = counters_[name];
+        if (!metric)
+        {
+            metric = std::make_unique<Counter>();
+        }
+        return *metric;
+    }
+
+    Gauge &Registry::gauge(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto &metric = gauges_[name];
+        if (!metric)
+        {
+            metric = std::make_unique<Gauge>();
+        }
+        return *metric;
+    }
+
+    Histogram &Registry::histogram(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto &metric = histograms_[name];
+        if (!metric)
+        {
+            metric = std::make_unique<Histogram>();
+        }
+        return *metric;
+    }
+
+    std::string Registry::summary(void)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string line;
+        auto append = [&line](const std::string &entry) { line += (line.empty() ? "" : " ") + entry; };
+
+        for (const auto &[name, histogram] : histograms_)
+        {
+            if (histogram->count() > 0)
+            {
+                append(name + "{n=" + std::to_string(histogram->count())
+                    + " p50=" + std::to_string(histogram->percentile(50))
+                    + " p99=" + std::to_string(histogram->percentile(99))
+                    + " max=" + std::to_string(histogram->max()) + "}");
+            }
+        }
+        for (const auto &[name, counter] : counters_)
+        {
+            if (counter->value() > 0)
+            {
+                append(name + "=" + std::to_string(counter->value()));
+            }
+        }
+        for (const auto &[name, gauge] : gauges_)
+        {
+            append(name + "=" + std::to_string(gauge->value()));
+        }
+        return line;
+    }
+
+    bool Registry::dumpToFile(const std::filesystem::path &path)
+    {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file)
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto &[name, histogram] : histograms_)
+        {
+            file << name
+                 << " count=" << histogram->count()
+                 << " mean=" << histogram->mean()
+                 << " p50=" << histogram->percentile(50)
+                 << " p90=" << histogram->percentile(90)
+                 << " p99=" << histogram->percentile(99)
+                 << " p999=" << histogram->percentile(99.9)
+                 << " max=" << histogram->max() << "\n";
+        }
+        for (const auto &[name, counter] : counters_)
+        {
+            file << name << " " << counter->value() << "\n";
+        }
+        for (const auto &[name, gauge] : gauges_)
+        {
+            file << name << " " << gauge->value() << "\n";
+        }
+        return static_cast<bool>(file);
+    }
+}
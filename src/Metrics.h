@@ -0,0 +1,115 @@
+// Metrics.h
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Metrics
+{
+    const std::chrono::seconds SUMMARY_INTERVAL = std::chrono::minutes(5); // Summary line in the log
+    const std::string DUMP_FILE_NAME = "CoFrance-metrics.txt";
+
+    class Counter
+    {
+        public:
+            void add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+            uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+        private:
+            std::atomic<uint64_t> value_ = 0;
+    };
+
+    class Gauge
+    {
+        public:
+            void set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+            int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+        private:
+            std::atomic<int64_t> value_ = 0;
+    };
+
+    // Lock-free log-linear histogram of microsecond latencies, HDR-style:
+    // 8 linear sub-buckets per power of two, so any value is within 12.5% of its bucket.
+    class Histogram
+    {
+        public:
+            static constexpr int SUB_BUCKET_BITS = 3;
+            static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+            static constexpr size_t BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+            void record(uint64_t micros);
+            void record(std::chrono::steady_clock::duration duration);
+
+            uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+            uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+            uint64_t mean() const;
+            uint64_t percentile(double percent) const;
+
+        private:
+            std::array<std::atomic<uint64_t>, BUCKETS> buckets_{};
+            std::atomic<uint64_t> count_ = 0;
+            std::atomic<uint64_t> sum_ = 0;
+            std::atomic<uint64_t> max_ = 0;
+
+            static size_t bucketIndex(uint64_t value);
+            static uint64_t bucketLowerBound(size_t index);
+    };
+
+    // Records the lifetime of the timer into a histogram
+    class ScopedTimer
+    {
+        public:
+            explicit ScopedTimer(Histogram &histogram) : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+            ~ScopedTimer() { histogram_.record(std::chrono::steady_clock::now() - start_); }
+
+        private:
+            Histogram &histogram_;
+            std::chrono::steady_clock::time_point start_;
+    };
+
+    class Registry;
+
+    // Latency and status classes of one external endpoint
+    class EndpointMetrics
+    {
+        public:
+            EndpointMetrics(Registry &registry, const std::string &name);
+
+            // status is 0 when no response was received
+            void record(int status, std::chrono::steady_clock::duration duration);
+
+        private:
+            Histogram &latency_;
+            Counter &status2xx_;
+            Counter &status3xx_;
+            Counter &status4xx_;
+            Counter &status5xx_;
+            Counter &failures_;
+    };
+
+    // Named metrics; registration locks, updates never do.
+    // Returned references stay valid for the registry lifetime.
+    class Registry
+    {
+        public:
+            Counter &counter(const std::string &name);
+            Gauge &gauge(const std::string &name);
+            Histogram &histogram(const std::string &name);
+
+            std::string summary(void);
+            bool dumpToFile(const std::filesystem::path &path);
+
+        private:
+            std::mutex mutex_;
+            std::map<std::string, std::unique_ptr<Counter>> counters_;
+            std::map<std::string, std::unique_ptr<Gauge>> gauges_;
+            std::map<std::string, std::unique_ptr<Histogram>> histograms_;
+    };
+}
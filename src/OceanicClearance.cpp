@@ -1,20 +1,198 @@
 // OceanicClearance.cpp
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numbers>
+#include <thread>
 #include "OceanicClearance.h"
 
 namespace OceanicClearance
 {
+    namespace
+    {
+        // Builds Clearance records straight from the Nattrak array, without a DOM
+        class NattrakSaxHandler : public nlohmann::json_sax<nlohmann::json>
+        {
+            public:
+                std::vector<Clearance> clearances;
+
+                bool null() override { return true; }
+                bool boolean(bool) override { return true; }
+                bool number_integer(number_integer_t value) override { return number(static_cast<long long>(value)); }
+                bool number_unsigned(number_unsigned_t value) override { return number(static_cast<long long>(value)); }
+                bool number_float(number_float_t, const string_t &) override { return true; }
+                bool binary(binary_t &) override { return true; }
+
+                bool string(string_t &value) override
+                {
+                    if (!inRecord_ || depth_ != 2)
+                    {
+                        return true;
+                    }
+                    Clearance &clearance = clearances.back();
+                    if (key_ == "callsign")
+                    {
+                        clearance.callsign = std::move(value);
+                    }
+                    else if (key_ == "status")
+                    {
+                        clearance.status = std::move(value);
+                    }
+                    else if (key_ == "level")
+                    {
+                        try
+                        {
+                            clearance.level = std::stoi(value) * 100;
+                        }
+                        catch (const std::exception &) {}
+                    }
+                    else if (key_ == "fix")
+                    {
+                        clearance.entryFix = std::move(value);
+                    }
+                    else if (key_ == "estimating_time")
+                    {
+                        clearance.entryTime = std::move(value);
+                    }
+                    return true;
+                }
+
+                bool start_object(std::size_t) override
+                {
+                    depth_++;
+                    if (depth_ == 2 && inArray_)
+                    {
+                        clearances.emplace_back();
+                        inRecord_ = true;
+                    }
+                    return true;
+                }
+
+                bool end_object() override
+                {
+                    // Records without the mandatory fields are dropped
+                    if (depth_ == 2 && inRecord_)
+                    {
+                        if (clearances.back().callsign.empty() || clearances.back().status.empty())
+                        {
+                            clearances.pop_back();
+                        }
+                        inRecord_ = false;
+                    }
+                    depth_--;
+                    return true;
+                }
+
+                bool start_array(std::size_t) override
+                {
+                    depth_++;
+                    if (depth_ == 1)
+                    {
+                        inArray_ = true;
+                    }
+                    return true;
+                }
+
+                bool end_array() override
+                {
+                    depth_--;
+                    return true;
+                }
+
+                bool key(string_t &value) override
+                {
+                    if (inRecord_ && depth_ == 2)
+                    {
+                        key_ = std::move(value);
+                    }
+                    return true;
+                }
+
+                bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &) override
+                {
+                    return false;
+                }
+
+            private:
+                int depth_ = 0;
+                bool inArray_ = false;
+                bool inRecord_ = false;
+                std::string key_;
+
+                bool number(long long value)
+                {
+                    if (inRecord_ && depth_ == 2 && key_ == "level")
+                    {
+                        clearances.back().level = static_cast<int>(value) * 100;
+                    }
+                    return true;
+                }
+        };
+
+        double greatCircleDistance(double latitude1, double longitude1, double latitude2, double longitude2)
+        {
+            constexpr double toRadians = std::numbers::pi / 180.0;
+            double dLatitude = (latitude2 - latitude1) * toRadians;
+            double dLongitude = (longitude2 - longitude1) * toRadians;
+            double a = std::sin(dLatitude / 2) * std::sin(dLatitude / 2)
+                + std::cos(latitude1 * toRadians) * std::cos(latitude2 * toRadians) * std::sin(dLongitude / 2) * std::sin(dLongitude / 2);
+            return 2 * EARTH_RADIUS_NM * std::asin(std::min(1.0, std::sqrt(a)));
+        }
+    }
+
     OceanicClearance::OceanicClearance(
-        PluginSDK::ControllerData::ControllerDataAPI &controllerDataAPI,
-        PluginSDK::Flightplan::FlightplanAPI &flightplanAPI,
+        Snapshot::SnapshotProvider &snapshotProvider,
         PluginSDK::Tag::TagAPI &tagAPI,
-        PluginSDK::Logger::LoggerAPI &logger
-    ) : controllerDataAPI_(controllerDataAPI),
-        flightplanAPI_(flightplanAPI),
+        TagUpdateQueue::TagUpdateQueue &tagUpdateQueue,
+        AsyncLogger::AsyncLogger &logger,
+        HttpClientPool::HttpClientPool &httpClientPool,
+        Scheduler::Scheduler &scheduler,
+        WorkerPool::WorkerPool &workerPool,
+        const Config::Config &config,
+        Metrics::Registry &metrics,
+        DiskCache::DiskCache &diskCache,
+        SharedCache::SharedCache &sharedCache
+    ) : snapshotProvider_(snapshotProvider),
         tagAPI_(tagAPI),
-        logger_(logger)
+        tagUpdateQueue_(tagUpdateQueue),
+        logger_(logger),
+        httpClientPool_(httpClientPool),
+        scheduler_(scheduler),
+        workerPool_(workerPool),
+        diskCache_(diskCache),
+        sharedCache_(sharedCache),
+        apiBase_(config.nattrakApiBase.empty() ? NATTRAK_API_BASE : config.nattrakApiBase),
+        cycleDuration_(metrics.histogram("oceanic.cycle_us")),
+        evaluationDuration_(metrics.histogram("oceanic.evaluation_us")),
+        nattrakEndpoint_(metrics, "http.nattrak"),
+        nattrakParseDuration_(metrics.histogram("oceanic.nattrak_parse_us")),
+        parseFailures_(metrics.counter("oceanic.parse_failures")),
+        flagUpdatesEmitted_(metrics.counter("oceanic.tag_updates.emitted")),
+        flagUpdatesSuppressed_(metrics.counter("oceanic.tag_updates.suppressed")),
+        incrementalEvaluations_(metrics.counter("oceanic.incremental_evaluations")),
+        clearanceCount_(metrics.gauge("oceanic.clearances")),
+        pollingIntervalGauge_(metrics.gauge("oceanic.polling_interval_ms")),
+        nattrakBreaker_("Nattrak API", logger, metrics),
+        nattrakLimiter_("Nattrak API",
+            config.nattrakRequestsPerMinute > 0 ? config.nattrakRequestsPerMinute : NATTRAK_REQUESTS_PER_MINUTE,
+            NATTRAK_BURST, logger, metrics),
+        pollingInterval_(
+            std::chrono::seconds(config.nattrakMinIntervalSec > 0 ? config.nattrakMinIntervalSec : MIN_POLLING_INTERVAL_SEC),
+            std::chrono::seconds(config.nattrakMaxIntervalSec > 0 ? config.nattrakMaxIntervalSec : MAX_POLLING_INTERVAL_SEC)),
+        evaluationThreads_(config.oceanicEvaluationThreads > 0 ? static_cast<size_t>(config.oceanicEvaluationThreads)
+            : std::max<size_t>(1, std::thread::hardware_concurrency()))
     {
 
-        logger_.info("Initializing OceanicClearance");
+        logger_.info(AsyncLogger::Category::Oceanic, "Initializing OceanicClearance");
+
+        for (const auto &rule : config.oceanicDestinations)
+        {
+            if (!oceanicDestinations_.addRule(rule))
+            {
+                logger_.warning(AsyncLogger::Category::Oceanic, "Ignoring invalid oceanic destination rule '{}'", rule);
+            }
+        }
     
         // Initialize the tag item for oceanic flag
         PluginSDK::Tag::TagItemDefinition tagDefinition;
@@ -23,192 +201,583 @@ namespace OceanicClearance
         tagDefinition.allowedActions = {};
         oceanicFlagId_ = tagAPI_.getInterface()->RegisterTagItem(tagDefinition);
         
-        logger_.info("OceanicClearance initialized successfully");
+        logger_.info(AsyncLogger::Category::Oceanic, "OceanicClearance initialized successfully");
     }
 
     void OceanicClearance::startPoller(void)
     {
-        if (!poolerRunning_)
+        if (!pollerRunning_.exchange(true))
         {
-            poolerRunning_ = true;
-            pollerThread_ = std::thread(&OceanicClearance::pollerThread, this);
-            logger_.info("OceanicClearance poller started");
+            publishedFlags_.clear();
+            refreshedAt_.clear();
+            restoreFromDiskCache();
+            pollerJob_ = scheduler_.addBlockingJob("OceanicClearance", pollingInterval_.current(), POLLING_JITTER, workerPool_,
+                [this](const std::atomic<bool> &cancelled) { poll(cancelled); });
+            dirtyCallsigns_.clear();
+            dirtyJob_ = scheduler_.addJob("OceanicClearance dirty", DIRTY_INTERVAL, std::chrono::milliseconds(0),
+                [this](const std::atomic<bool> &cancelled) { processDirty(cancelled); }, DIRTY_INTERVAL);
+            logger_.info(AsyncLogger::Category::Oceanic, "OceanicClearance poller started");
         }
     }
 
     void OceanicClearance::stopPoller(void)
     {
-        if (poolerRunning_)
+        if (pollerRunning_.exchange(false))
         {
-            poolerRunning_ = false;
-            if (pollerThread_.joinable())
+            auto stopStart = std::chrono::steady_clock::now();
+            scheduler_.cancelJob(dirtyJob_);
+            scheduler_.cancelJob(pollerJob_);
+            sharedCache_.releaseFetcher(SharedCache::Section::OceanicClearances);
+            auto stopDuration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - stopStart);
+            logger_.info(AsyncLogger::Category::Oceanic, "OceanicClearance poller stopped in {} ms", stopDuration.count());
+        }
+    }
+
+    void OceanicClearance::poll(const std::atomic<bool> &cancelled)
+    {
+        Metrics::ScopedTimer cycleTimer(cycleDuration_);
+
+        // Only one instance of the host downloads Nattrak, the others read what it shares
+        std::optional<std::vector<Clearance>> nattrakData;
+        if (sharedCache_.acquireFetcher(SharedCache::Section::OceanicClearances))
+        {
+            nattrakData = getNattrakData();
+            if (nattrakData)
             {
-                pollerThread_.join();
+                saveClearances(*nattrakData);
             }
-            logger_.info("OceanicClearance poller stopped");
+        }
+        else
+        {
+            auto records = sharedCache_.readIfNewer(SharedCache::Section::OceanicClearances, sharedClearancesSequence_, CLEARANCES_CACHE_MAX_AGE);
+            if (records)
+            {
+                nattrakData = fromRecords(*records);
+            }
+        }
+        // Poll faster while clearances are being issued, slower while nothing changes
+        auto previousClearances = getClearances();
+        if (nattrakData)
+        {
+            auto clearances = buildClearanceIndex(std::move(*nattrakData));
+            clearanceCount_.set(static_cast<int64_t>(clearances->size()));
+            if (*clearances != *previousClearances)
+            {
+                pollingInterval_.recordChanged();
+            }
+            else
+            {
+                pollingInterval_.recordUnchanged();
+            }
+            std::lock_guard<std::mutex> lock(clearancesMutex_);
+            clearances_ = std::move(clearances);
+        }
+        else
+        {
+            pollingInterval_.recordUnchanged();
+        }
+        scheduler_.setPeriod(pollerJob_, pollingInterval_.current());
+        pollingIntervalGauge_.set(static_cast<int64_t>(pollingInterval_.current().count()));
+        auto clearances = getClearances();
+
+        // The download is done, from here on the dirty job waits for the flags to be published
+        std::lock_guard<std::mutex> evaluationLock(evaluationMutex_);
+        auto snapshot = snapshotProvider_.get();
+        {
+            Metrics::ScopedTimer evaluationTimer(evaluationDuration_);
+            evaluateFlights(*snapshot, *clearances, cancelled, evaluations_);
+        }
+        if (cancelled)
+        {
+            return;
+        }
+
+        // Geometries and flags are applied on this thread, in snapshot order. Flights the dirty
+        // job evaluated after the snapshot was taken already show newer data.
+        std::erase_if(refreshedAt_, [&snapshot](const auto &entry) { return entry.second < snapshot->takenAt(); });
+        const auto &flightplans = snapshot->flightplans();
+        for (size_t i = 0; i < flightplans.size(); i++)
+        {
+            Interner::Id callsign = names_.intern(flightplans[i].callsign);
+            if (refreshedAt_.contains(callsign))
+            {
+                continue;
+            }
+            if (evaluations_[i].rebuiltGeometry)
+            {
+                routeGeometries_.insert_or_assign(callsign, std::move(*evaluations_[i].rebuiltGeometry));
+            }
+            if (evaluations_[i].flag)
+            {
+                updateOceanicFlag(callsign, evaluations_[i].flag->value, evaluations_[i].flag->colour);
+            }
+        }
+
+        // Forget the flags of flight plans that are gone, unless they appeared after the snapshot
+        auto gone = [this, &snapshot](const auto &entry)
+        {
+            return !snapshot->getFlightplan(names_.name(entry.first)) && !refreshedAt_.contains(entry.first);
+        };
+        std::erase_if(publishedFlags_, gone);
+        std::erase_if(routeGeometries_, gone);
+        logger_.debug(AsyncLogger::Category::Oceanic, "Oceanic flag updates: {} emitted, {} suppressed", flagUpdatesEmitted_.value(), flagUpdatesSuppressed_.value());
+    }
+
+    void OceanicClearance::markDirty(const std::string &callsign)
+    {
+        if (pollerRunning_)
+        {
+            dirtyCallsigns_.mark(callsign);
         }
     }
 
-    void OceanicClearance::pollerThread(void)
+    void OceanicClearance::processDirty(const std::atomic<bool> &cancelled)
     {
-        int counter_sec = 0;
-        std::string oceanicFlag;
+        auto dirtyCallsigns = dirtyCallsigns_.drain();
+        if (dirtyCallsigns.empty())
+        {
+            return;
+        }
 
-        // Poller loop
-        while (poolerRunning_)
+        auto clearances = getClearances();
+        std::lock_guard<std::mutex> evaluationLock(evaluationMutex_);
+        for (const auto &callsign : dirtyCallsigns)
         {
-            if (counter_sec % POLLING_INTERVAL_SEC == 0)
+            if (cancelled)
             {
-                nattrakData_ = getNattrakData();
-                std::vector<PluginSDK::Flightplan::Flightplan> flightplans = flightplanAPI_.getAll();
-                for (auto flightplan : flightplans)
-                {
-                    /*
-                    if BREST_OCEANIC_POINTS is in the route
-                        if has OCL
-                            if OCL level is same as the cleared level or the flight plan level
-                                set OCL
-                            else
-                                set LCHG + flight level
-                        else if the destination is Americas (ICAOs starting with KCPSTMN, and SPEM)
-                            if the exist of sector is withing 30 minutes
-                                if exist of sector is within 15 minutes
-                                    set OCL yellow
-                                else
-                                    set OCL blue
+                return;
+            }
+
+            Interner::Id callsignId = names_.intern(callsign);
+            refreshedAt_.insert_or_assign(callsignId, std::chrono::steady_clock::now());
+            auto flightplan = snapshotProvider_.fetchFlightplan(callsign);
+            if (flightplan)
+            {
+                evaluateFlight(*clearances, *flightplan);
+                incrementalEvaluations_.add();
+            }
+            else
+            {
+                publishedFlags_.erase(callsignId);
+                routeGeometries_.erase(callsignId);
+            }
+        }
+    }
+
+    void OceanicClearance::evaluateFlight(const ClearanceIndex &clearances, const PluginSDK::Flightplan::Flightplan &flightplan)
+    {
+        const Clearance *clearance = findClearance(clearances, flightplan.callsign);
+        auto controllerData = clearance ? snapshotProvider_.fetchControllerData(flightplan.callsign) : std::nullopt;
+        auto aircraft = snapshotProvider_.fetchAircraft(flightplan.callsign);
+        auto flag = computeFlag(oceanicDestinations_, flightplan, getRouteGeometry(flightplan), clearance,
+            controllerData ? &*controllerData : nullptr, aircraft ? &*aircraft : nullptr);
+        if (flag)
+        {
+            updateOceanicFlag(names_.intern(flightplan.callsign), flag->value, flag->colour);
+        }
+    }
+
+    std::optional<PublishedFlag> OceanicClearance::computeFlag(const IcaoClassifier::IcaoClassifier &oceanicDestinations,
+        const PluginSDK::Flightplan::Flightplan &flightplan, const RouteGeometry &geometry, const Clearance *clearance,
+        const PluginSDK::ControllerData::ControllerDataModel *controllerData, const PluginSDK::Aircraft::Aircraft *aircraft)
+    {
+        /*
+        if BREST_OCEANIC_POINTS is in the route
+            if has OCL
+                if OCL level is same as the cleared level or the flight plan level
+                    set OCL
+                else
+                    set LCHG + flight level
+            else if the destination is Americas (ICAOs starting with KCPSTMN, and SPEM)
+                if the exist of sector is withing 30 minutes
+                    if exist of sector is within 15 minutes
+                        set OCL orange
                     else
-                        set empty
-                    
-                    */
-                    if (flightplan.isValid && stringContainsValue(flightplan.route.rawRoute, BREST_OCEANIC_POINTS))
-                    {
-                        if (hasOceanicClearance(flightplan.callsign))
-                        {
-                            auto controllerData = controllerDataAPI_.getByCallsign(flightplan.callsign);
-                            if (controllerData)
-                            {
-                                int oeanicFlightLevel = getOceanicFlightLevel(flightplan.callsign);
-                                int clearedFlightLevel = controllerData->clearedFlightLevel;
-                                if (clearedFlightLevel == 0)
-                                {
-                                    clearedFlightLevel = flightplan.plannedAltitude;
-                                }
-                                if (clearedFlightLevel == oeanicFlightLevel)
-                                {
-                                    oceanicFlag = "OCL";
-                                    updateOceanicFlag(flightplan.callsign, oceanicFlag, COLOR_OCEANIC_CLEARANCE);
-                                }
-                                else
-                                {
-                                    oceanicFlag = "LCHG" + std::to_string(oeanicFlightLevel / 1000);
-                                    updateOceanicFlag(flightplan.callsign, oceanicFlag, COLOR_OCEANIC_CLEARANCE);
-                                }
-                            }
-                        }
-                        else if (std::regex_match(flightplan.destination, OCEANIC_DESTINATION_REGEX))
-                        {
-                            oceanicFlag = "OCL";
-                            updateOceanicFlag(flightplan.callsign, oceanicFlag, COLOR_NO_OCEANIC_CLEARANCE);
-                        }
-                        else
-                        {   
-                            oceanicFlag = "";
-                            updateOceanicFlag(flightplan.callsign, oceanicFlag, COLOR_DEFAULT);
-                        }
-                    }
-                    else 
-                    {
-                        oceanicFlag = "";
-                        updateOceanicFlag(flightplan.callsign, oceanicFlag, COLOR_DEFAULT);
-                    }
+                        set OCL violet
+        else
+            set empty
+        
+        */
+        if (!flightplan.isValid || !geometry.exit)
+        {
+            return PublishedFlag{"", COLOR_DEFAULT};
+        }
+
+        if (clearance)
+        {
+            if (!controllerData)
+            {
+                return std::nullopt;
+            }
+            int oeanicFlightLevel = clearance->level;
+            int clearedFlightLevel = controllerData->clearedFlightLevel;
+            if (clearedFlightLevel == 0)
+            {
+                clearedFlightLevel = flightplan.plannedAltitude;
+            }
+            if (clearedFlightLevel == oeanicFlightLevel)
+            {
+                return PublishedFlag{"OCL", COLOR_OCEANIC_CLEARANCE};
+            }
+            return PublishedFlag{"LCHG" + std::to_string(oeanicFlightLevel / 1000), COLOR_OCEANIC_CLEARANCE};
+        }
+
+        if (oceanicDestinations.matches(flightplan.destination))
+        {
+            // Staged on the time to the exit fix, flights without one are flagged straight away
+            auto exitTime = aircraft ? timeToExit(geometry, *aircraft) : std::nullopt;
+            if (!exitTime || *exitTime <= EXIT_WARNING_TIME)
+            {
+                return PublishedFlag{"OCL", COLOR_NO_OCEANIC_CLEARANCE};
+            }
+            if (*exitTime <= EXIT_NOTICE_TIME)
+            {
+                return PublishedFlag{"OCL", COLOR_OCEANIC_CLEARANCE_NOTICE};
+            }
+        }
+        return PublishedFlag{"", COLOR_DEFAULT};
+    }
+
+    void OceanicClearance::evaluateFlights(const Snapshot::Snapshot &snapshot, const ClearanceIndex &clearances, const std::atomic<bool> &cancelled,
+        std::vector<FlightEvaluation> &evaluations) const
+    {
+        const auto &flightplans = snapshot.flightplans();
+        evaluations.clear();
+        evaluations.resize(flightplans.size());
+
+        // Each chunk writes its own slots. The route geometries and published flags are only read,
+        // the poller holds evaluationMutex_ until the results are applied.
+        size_t chunkCount = (flightplans.size() + EVALUATION_CHUNK_SIZE - 1) / EVALUATION_CHUNK_SIZE;
+        workerPool_.parallelFor(chunkCount, evaluationThreads_, [&](size_t chunk)
+        {
+            if (cancelled)
+            {
+                return;
+            }
+            size_t begin = chunk * EVALUATION_CHUNK_SIZE;
+            size_t end = std::min(begin + EVALUATION_CHUNK_SIZE, flightplans.size());
+
+            // Controller data of the cleared flights of the chunk in one go, the only snapshot data behind a lock
+            std::vector<const Clearance *> chunkClearances(end - begin);
+            std::vector<const std::string *> clearedCallsigns;
+            for (size_t i = begin; i < end; i++)
+            {
+                chunkClearances[i - begin] = findClearance(clearances, flightplans[i].callsign);
+                if (chunkClearances[i - begin])
+                {
+                    clearedCallsigns.push_back(&flightplans[i].callsign);
+                }
+            }
+            std::vector<const PluginSDK::ControllerData::ControllerDataModel *> controllerData;
+            snapshot.getControllerData(clearedCallsigns, controllerData);
+
+            size_t cleared = 0;
+            for (size_t i = begin; i < end; i++)
+            {
+                const auto &flightplan = flightplans[i];
+                auto callsign = names_.find(flightplan.callsign);
+                auto cached = callsign ? routeGeometries_.find(*callsign) : routeGeometries_.end();
+                size_t routeHash = std::hash<std::string>{}(flightplan.route.rawRoute);
+                if (cached == routeGeometries_.end() || cached->second.routeHash != routeHash)
+                {
+                    evaluations[i].rebuiltGeometry = buildRouteGeometry(flightplan, routeHash);
                 }
+                const RouteGeometry &geometry = evaluations[i].rebuiltGeometry ? *evaluations[i].rebuiltGeometry : cached->second;
+                const Clearance *clearance = chunkClearances[i - begin];
+                evaluations[i].flag = computeFlag(oceanicDestinations_, flightplan, geometry, clearance,
+                    clearance ? controllerData[cleared++] : nullptr, snapshot.getAircraft(flightplan.callsign));
             }
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-            counter_sec++;
+        });
+    }
+
+    const RouteGeometry &OceanicClearance::getRouteGeometry(const PluginSDK::Flightplan::Flightplan &flightplan)
+    {
+        Interner::Id callsign = names_.intern(flightplan.callsign);
+        size_t routeHash = std::hash<std::string>{}(flightplan.route.rawRoute);
+        auto cached = routeGeometries_.find(callsign);
+        if (cached != routeGeometries_.end() && cached->second.routeHash == routeHash)
+        {
+            return cached->second;
         }
+        return routeGeometries_.insert_or_assign(callsign, buildRouteGeometry(flightplan, routeHash)).first->second;
     }
 
-    void OceanicClearance::updateOceanicFlag(std::string callsign, std::string value, std::array<unsigned int, 3> colour)
+    RouteGeometry OceanicClearance::buildRouteGeometry(const PluginSDK::Flightplan::Flightplan &flightplan, size_t routeHash) const
     {
-        PluginSDK::Tag::TagContext context;
-        context.callsign = callsign;
-        context.colour = colour;
-        tagAPI_.getInterface()->UpdateTagValue(oceanicFlagId_, value, context);
-#ifdef DEBUG
-        logger_.info("Update Oceanic Flag for " + callsign + " to '" + value + "'");
-#endif
+        RouteGeometry geometry;
+        geometry.routeHash = routeHash;
+        geometry.exit = BREST_OCEANIC_POINTS.findFirst(flightplan.route.rawRoute);
+        if (!geometry.exit)
+        {
+            return geometry;
+        }
+
+        // The exit fix is interned as listed, the route may spell it in lower case
+        RouteMatcher::forEachToken(flightplan.route.rawRoute, [this, &geometry](std::string_view token, size_t tokenIndex, size_t)
+        {
+            geometry.fixes.push_back(names_.intern(tokenIndex < geometry.exit->tokenIndex ? token : geometry.exit->fix));
+            return tokenIndex < geometry.exit->tokenIndex;
+        });
+
+        // Waypoints up to the exit fix, without it in the expanded route there is no geometry
+        const auto &waypoints = flightplan.route.waypoints;
+        auto exitWaypoint = std::find_if(waypoints.begin(), waypoints.end(),
+            [this, &geometry](const auto &waypoint) { return names_.find(waypoint.identifier) == geometry.fixes.back(); });
+        if (exitWaypoint == waypoints.end())
+        {
+            return geometry;
+        }
+
+        for (auto waypoint = waypoints.begin(); waypoint != std::next(exitWaypoint); waypoint++)
+        {
+            geometry.points.push_back(waypoint->position);
+        }
+        geometry.remainingNm.resize(geometry.points.size());
+        for (size_t i = geometry.points.size() - 1; i-- > 0;)
+        {
+            geometry.remainingNm[i] = geometry.remainingNm[i + 1] + greatCircleDistance(
+                geometry.points[i].latitude, geometry.points[i].longitude, geometry.points[i + 1].latitude, geometry.points[i + 1].longitude);
+        }
+        return geometry;
     }
 
-    nlohmann::json OceanicClearance::getNattrakData(void)
+    std::optional<std::chrono::seconds> OceanicClearance::timeToExit(const RouteGeometry &geometry, const PluginSDK::Aircraft::Aircraft &aircraft)
     {
-        httplib::Client cli(NATTRAK_API_BASE);
+        if (geometry.points.empty() || aircraft.position.groundSpeed < MIN_GROUND_SPEED_FOR_ETA)
+        {
+            return std::nullopt;
+        }
+
+        // Shortest path joining the route at one of its points, which is through the next waypoint ahead
+        double distance = std::numeric_limits<double>::infinity();
+        for (size_t i = 0; i < geometry.points.size(); i++)
+        {
+            distance = std::min(distance, geometry.remainingNm[i] + greatCircleDistance(
+                aircraft.position.latitude, aircraft.position.longitude, geometry.points[i].latitude, geometry.points[i].longitude));
+        }
+        return std::chrono::seconds(static_cast<long long>(distance / aircraft.position.groundSpeed * 3600.0));
+    }
+
+    void OceanicClearance::updateOceanicFlag(Interner::Id callsign, const std::string &value, const std::array<unsigned int, 3> &colour)
+    {
+        // A callsign without a record still shows the tag default
+        auto published = publishedFlags_.find(callsign);
+        bool unchanged = published != publishedFlags_.end()
+            ? published->second.value == value && published->second.colour == colour
+            : value.empty() && colour == COLOR_DEFAULT;
+        if (unchanged)
+        {
+            flagUpdatesSuppressed_.add();
+            return;
+        }
+
+        tagUpdateQueue_.push(oceanicFlagId_, names_.name(callsign), value, colour);
+        flagUpdatesEmitted_.add();
+        if (published != publishedFlags_.end())
+        {
+            published->second.value = value;
+            published->second.colour = colour;
+        }
+        else
+        {
+            publishedFlags_.emplace(callsign, PublishedFlag{value, colour});
+        }
+        logger_.debug(AsyncLogger::Category::Oceanic, "Update Oceanic Flag for {} to '{}'", names_.name(callsign), value);
+    }
+
+    std::optional<std::vector<Clearance>> OceanicClearance::getNattrakData(void)
+    {
+        // While Nattrak is down or the budget is spent the last good clearances keep being served
+        if (!nattrakBreaker_.allowRequest())
+        {
+            return std::nullopt;
+        }
+        if (!nattrakLimiter_.tryAcquire())
+        {
+            nattrakBreaker_.abandonProbe();
+            return std::nullopt;
+        }
+
+        auto cli = httpClientPool_.acquire(apiBase_, REQUEST_DEADLINE);
+        httplib::Headers headers = {{"Accept-Encoding", "gzip"}};
+        if (!nattrakETag_.empty())
+        {
+            headers.emplace("If-None-Match", nattrakETag_);
+        }
+        if (!nattrakLastModified_.empty())
+        {
+            headers.emplace("If-Modified-Since", nattrakLastModified_);
+        }
+
+        // The body is decompressed chunk by chunk as it is received.
+        // Returning false from the receiver cancels a download running past the deadline.
+        std::string body;
         httplib::Result result;
-        
+        auto requestStart = std::chrono::steady_clock::now();
+        auto deadline = requestStart + REQUEST_DEADLINE;
         try {
-            result = cli.Get(NATTRAK_API_CLEARANCE);
+            result = cli->Get(NATTRAK_API_CLEARANCE, headers, [&body, deadline](const char *data, size_t length) {
+                body.append(data, length);
+                return std::chrono::steady_clock::now() < deadline;
+            });
         }
         catch (const std::exception &e)
         {
-            logger_.error("Failed to connect to Nattrak API: " + std::string(e.what()));
-            return nlohmann::json();
+            nattrakEndpoint_.record(0, std::chrono::steady_clock::now() - requestStart);
+            nattrakBreaker_.recordFailure();
+            logger_.error(AsyncLogger::Category::Oceanic, "Failed to connect to Nattrak API: {}", e.what());
+            return std::nullopt;
+        }
+        nattrakEndpoint_.record(result ? result->status : 0, std::chrono::steady_clock::now() - requestStart);
+
+        if (!result) {
+            nattrakBreaker_.recordFailure();
+            logger_.error(AsyncLogger::Category::Oceanic, "Failed to connect to Nattrak API: {}", httplib::to_string(result.error()));
+            return std::nullopt;
+        }
+        nattrakLimiter_.recordResponse(result->status, result->get_header_value("Retry-After"));
+        if (CircuitBreaker::CircuitBreaker::isFailureStatus(result->status))
+        {
+            nattrakBreaker_.recordFailure();
+        }
+        else
+        {
+            nattrakBreaker_.recordSuccess();
+        }
+
+        if (result->status == httplib::StatusCode::NotModified_304) {
+            return std::nullopt;
         }
-        
         if (result->status != httplib::StatusCode::OK_200) {
-            logger_.error("Nattrak API returned error: " + std::to_string(result->status));
-            return nlohmann::json();
+            logger_.error(AsyncLogger::Category::Oceanic, "Nattrak API returned error: {}", result->status);
+            return std::nullopt;
         }
-        
-        return nlohmann::json::parse(result->body);
+
+        std::optional<std::vector<Clearance>> clearances;
+        {
+            Metrics::ScopedTimer parseTimer(nattrakParseDuration_);
+            clearances = parseNattrakData(body);
+        }
+        if (!clearances)
+        {
+            parseFailures_.add();
+            logger_.error(AsyncLogger::Category::Oceanic, "Failed to parse Nattrak data");
+            return std::nullopt;
+        }
+
+        // Only remember the validators once the payload they describe is in use
+        nattrakETag_ = result->get_header_value("ETag");
+        nattrakLastModified_ = result->get_header_value("Last-Modified");
+        return clearances;
     }
 
-    bool OceanicClearance::hasOceanicClearance(std::string callsign)
+    std::optional<std::vector<Clearance>> OceanicClearance::parseNattrakData(const std::string &body)
     {
-        try
-        {
-            for (auto ocl : nattrakData_)
+        NattrakSaxHandler handler;
+        try {
+            if (!nlohmann::json::sax_parse(body, &handler))
             {
-                if (ocl.contains("callsign") && ocl.contains("status"))
-                {
-                    if (ocl["callsign"] == callsign && ocl["status"] == "CLEARED") {
-                        return true;
-                    }
-                }
+                return std::nullopt;
             }
         }
-        catch (std::exception& exc) {}
-        return false;
+        catch (const std::exception &)
+        {
+            return std::nullopt;
+        }
+        return std::move(handler.clearances);
     }
 
-    int OceanicClearance::getOceanicFlightLevel(std::string callsign)
+    void OceanicClearance::restoreFromDiskCache(void)
     {
-        try
+        if (!getClearances()->empty())
         {
-            for (auto ocl : nattrakData_)
+            return;
+        }
+
+        auto records = diskCache_.load(CLEARANCES_CACHE_SECTION, CLEARANCES_CACHE_MAX_AGE);
+        if (!records)
+        {
+            return;
+        }
+
+        auto clearances = buildClearanceIndex(fromRecords(*records));
+        logger_.info(AsyncLogger::Category::Oceanic, "Restored {} oceanic clearances from cache", clearances->size());
+        clearanceCount_.set(static_cast<int64_t>(clearances->size()));
+        std::lock_guard<std::mutex> lock(clearancesMutex_);
+        clearances_ = std::move(clearances);
+    }
+
+    void OceanicClearance::saveClearances(const std::vector<Clearance> &clearanceList)
+    {
+        std::vector<DiskCache::Record> records = toRecords(clearanceList);
+        diskCache_.save(CLEARANCES_CACHE_SECTION, records);
+        sharedCache_.publish(SharedCache::Section::OceanicClearances, records);
+    }
+
+    std::vector<DiskCache::Record> OceanicClearance::toRecords(const std::vector<Clearance> &clearanceList)
+    {
+        std::vector<DiskCache::Record> records;
+        records.reserve(clearanceList.size());
+        for (const auto &clearance : clearanceList)
+        {
+            records.push_back({clearance.callsign, clearance.status, std::to_string(clearance.level), clearance.entryFix, clearance.entryTime});
+        }
+        return records;
+    }
+
+    std::vector<Clearance> OceanicClearance::fromRecords(const std::vector<DiskCache::Record> &records)
+    {
+        std::vector<Clearance> clearanceList;
+        clearanceList.reserve(records.size());
+        for (const auto &record : records)
+        {
+            if (record.size() != 5)
             {
-                if (ocl.contains("callsign") && ocl.contains("status") && ocl.contains("level"))
-                {
-                    if (ocl["callsign"] == callsign && ocl["status"] == "CLEARED") 
-                    {
-                        return std::stoi(ocl["level"].get<std::string>())*100;
-                    }
-                }
+                continue;
+            }
+            Clearance clearance{record[0], record[1], 0, record[3], record[4]};
+            try {
+                clearance.level = std::stoi(record[2]);
+            }
+            catch (const std::exception &)
+            {
+                continue;
             }
+            clearanceList.push_back(std::move(clearance));
         }
-        catch (std::exception& exc) {}
-        return 0;
+        return clearanceList;
     }
 
-    bool OceanicClearance::stringContainsValue(const std::string &str, const std::vector<std::string> &values)
+    std::shared_ptr<const ClearanceIndex> OceanicClearance::buildClearanceIndex(std::vector<Clearance> clearanceList)
     {
-        std::string strUpper = str;
-        std::transform(strUpper.begin(), strUpper.end(), strUpper.begin(), ::toupper);
-        for (const auto &value : values)
+        auto clearances = std::make_shared<ClearanceIndex>();
+        clearances->reserve(clearanceList.size());
+        for (auto &clearance : clearanceList)
         {
-            if (strUpper.find(value) != std::string::npos)
+            // Keep the cleared record when a callsign appears more than once
+            auto it = clearances->find(clearance.callsign);
+            if (it == clearances->end() || (!it->second.isCleared() && clearance.isCleared()))
             {
-                return true;
+                std::string callsign = clearance.callsign;
+                (*clearances)[std::move(callsign)] = std::move(clearance);
             }
         }
-        return false;
+        return clearances;
+    }
+
+    std::shared_ptr<const ClearanceIndex> OceanicClearance::getClearances(void)
+    {
+        std::lock_guard<std::mutex> lock(clearancesMutex_);
+        return clearances_;
+    }
+
+    const Clearance *OceanicClearance::findClearance(const ClearanceIndex &clearances, const std::string &callsign)
+    {
+        auto it = clearances.find(callsign);
+        if (it == clearances.end() || !it->second.isCleared())
+        {
+            return nullptr;
+        }
+        return &it->second;
     }
 }
\ No newline at end of file
@@ -1,60 +1,221 @@
 // OceanicClearance.h
 #pragma once
-#define CPPHTTPLIB_OPENSSL_SUPPORT
-#include <httplib.h>
-#include <regex>
-#include <thread>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
 #include <nlohmann/json.hpp>
 #include <NeoRadarSDK/SDK.h>
+#include "AsyncLogger.h"
+#include "CircuitBreaker.h"
+#include "Config.h"
+#include "DirtySet.h"
+#include "DiskCache.h"
+#include "HttpClientPool.h"
+#include "Metrics.h"
+#include "RateLimiter.h"
+#include "IcaoClassifier.h"
+#include "Interner.h"
+#include "RouteMatcher.h"
+#include "Scheduler.h"
+#include "SharedCache.h"
+#include "Snapshot.h"
+#include "TagUpdateQueue.h"
+#include "WorkerPool.h"
 
 namespace OceanicClearance
 {
-    const int POLLING_INTERVAL_SEC = 60; // Polling interval in seconds
+    const int MIN_POLLING_INTERVAL_SEC = 30; // While clearances keep changing
+    const int MAX_POLLING_INTERVAL_SEC = 120; // While the payload is unchanged, also bounds the full reconciliation
+    const double NATTRAK_REQUESTS_PER_MINUTE = 4;
+    const double NATTRAK_BURST = 2;
+    const std::chrono::milliseconds POLLING_JITTER = std::chrono::seconds(3);
+    const std::chrono::milliseconds REQUEST_DEADLINE = std::chrono::seconds(10); // Whole Nattrak download
+    const std::chrono::milliseconds DIRTY_INTERVAL = std::chrono::milliseconds(250); // Flights changed by SDK events
+    const size_t EVALUATION_CHUNK_SIZE = 256; // Flights per worker pool task of a full pass
+    const std::chrono::minutes EXIT_NOTICE_TIME = std::chrono::minutes(30);  // Uncleared flights show a violet OCL from here
+    const std::chrono::minutes EXIT_WARNING_TIME = std::chrono::minutes(15); // and an orange one from here
+    const int MIN_GROUND_SPEED_FOR_ETA = 50; // Knots, slower aircraft have no exit time
+    const double EARTH_RADIUS_NM = 3440.065;
     const std::array<unsigned int, 3> COLOR_DEFAULT = {255, 255, 255};
     const std::array<unsigned int, 3> COLOR_OCEANIC_CLEARANCE = {114, 216, 250};
     const std::array<unsigned int, 3> COLOR_NO_OCEANIC_CLEARANCE = {249, 168, 0};
+    const std::array<unsigned int, 3> COLOR_OCEANIC_CLEARANCE_NOTICE = {190, 150, 255}; // Uncleared, exit getting close
+    const std::chrono::hours CLEARANCES_CACHE_MAX_AGE = std::chrono::hours(6);
+    const std::string CLEARANCES_CACHE_SECTION = "oceanic_clearances";
     const std::string OCEANIC_FLAG_TAG = "oceanic_flag";
     const std::string NATTRAK_API_BASE = "https://nattrak.vatsim.net";
     const std::string NATTRAK_API_CLEARANCE = "/api/plugins";
-    const std::vector<std::string> BREST_OCEANIC_POINTS = {"REGHI", "UMLER", "LAPEX", "BUNAV", "RIVAK", "ETIKI", "SEPAL", "SIVIR", "LARLA"};
-    const std::regex OCEANIC_DESTINATION_REGEX("([KCPTSMN][A-Z]{3}|LFVP|LFVM)");
+    constexpr RouteMatcher::FixSet<9> BREST_OCEANIC_POINTS({"REGHI", "UMLER", "LAPEX", "BUNAV", "RIVAK", "ETIKI", "SEPAL", "SIVIR", "LARLA"});
+    constexpr IcaoClassifier::IcaoClassifier OCEANIC_DESTINATIONS("KCPTSMN", {"LFVP", "LFVM"});
+
+    // Compact record of a Nattrak clearance, built once per fetch
+    struct Clearance
+    {
+        std::string callsign;
+        std::string status;
+        int level = 0;           // Cleared level in feet
+        std::string entryFix;
+        std::string entryTime;
+
+        bool isCleared() const { return status == "CLEARED"; }
+        bool operator==(const Clearance &other) const = default;
+    };
+    using ClearanceIndex = std::unordered_map<std::string, Clearance>;
+
+    // Route of a flight plan up to the Brest exit fix, parsed once per route revision.
+    // remainingNm[i] is the along-track distance from points[i] to the exit fix.
+    struct RouteGeometry
+    {
+        size_t routeHash = 0;               // Raw route it was built from
+        std::optional<RouteMatcher::Match> exit;
+        std::vector<Interner::Id> fixes;    // Route tokens up to the exit fix, the last one being it
+        std::vector<PluginSDK::Flightplan::Position> points;
+        std::vector<double> remainingNm;
+    };
+
+    // Last value and colour sent to the tag of a callsign
+    struct PublishedFlag
+    {
+        std::string value;
+        std::array<unsigned int, 3> colour;
+    };
+
+    // Outcome of one flight plan in a full pass, merged in snapshot order once all are done
+    struct FlightEvaluation
+    {
+        std::optional<PublishedFlag> flag; // Nothing to send when controller data is missing
+        std::optional<RouteGeometry> rebuiltGeometry; // Route changed since the cached geometry
+    };
 
     class OceanicClearance
     {
         public:
             OceanicClearance(
-                PluginSDK::ControllerData::ControllerDataAPI &controllerDataAPI,
-                PluginSDK::Flightplan::FlightplanAPI &flightplanAPI,
+                Snapshot::SnapshotProvider &snapshotProvider,
                 PluginSDK::Tag::TagAPI &tagAPI,
-                PluginSDK::Logger::LoggerAPI &logger
+                TagUpdateQueue::TagUpdateQueue &tagUpdateQueue,
+                AsyncLogger::AsyncLogger &logger,
+                HttpClientPool::HttpClientPool &httpClientPool,
+                Scheduler::Scheduler &scheduler,
+                WorkerPool::WorkerPool &workerPool,
+                const Config::Config &config,
+                Metrics::Registry &metrics,
+                DiskCache::DiskCache &diskCache,
+                SharedCache::SharedCache &sharedCache
             );
             ~OceanicClearance() = default;
 
             void startPoller();
             void stopPoller();
 
+            // Flight plan or controller data of a callsign changed, its flag is recomputed on the next dirty run
+            void markDirty(const std::string &callsign);
+
+            // Clearances of a Nattrak answer through the SAX handler, nothing when the body is not JSON
+            static std::optional<std::vector<Clearance>> parseNattrakData(const std::string &body);
+
         private:
-            PluginSDK::ControllerData::ControllerDataAPI &controllerDataAPI_;
-            PluginSDK::Flightplan::FlightplanAPI &flightplanAPI_;
+            Snapshot::SnapshotProvider &snapshotProvider_;
             PluginSDK::Tag::TagAPI &tagAPI_;
-            PluginSDK::Logger::LoggerAPI &logger_;
+            TagUpdateQueue::TagUpdateQueue &tagUpdateQueue_;
+            AsyncLogger::AsyncLogger &logger_;
+            HttpClientPool::HttpClientPool &httpClientPool_;
+            Scheduler::Scheduler &scheduler_;
+            WorkerPool::WorkerPool &workerPool_;
+            DiskCache::DiskCache &diskCache_;
+            SharedCache::SharedCache &sharedCache_;
             std::string oceanicFlagId_;
+            std::string apiBase_;
+
+            // Metrics
+            Metrics::Histogram &cycleDuration_;
+            Metrics::Histogram &evaluationDuration_;
+            Metrics::EndpointMetrics nattrakEndpoint_;
+            Metrics::Histogram &nattrakParseDuration_;
+            Metrics::Counter &parseFailures_;
+            Metrics::Counter &flagUpdatesEmitted_;
+            Metrics::Counter &flagUpdatesSuppressed_;
+            Metrics::Counter &incrementalEvaluations_;
+            Metrics::Gauge &clearanceCount_;
+            Metrics::Gauge &pollingIntervalGauge_;
+            CircuitBreaker::CircuitBreaker nattrakBreaker_;
+            RateLimiter::TokenBucket nattrakLimiter_;
+
+            // Destinations flagged when no clearance was found, defaults plus configured rules
+            IcaoClassifier::IcaoClassifier oceanicDestinations_ = OCEANIC_DESTINATIONS;
+
+            // Poller job on the plugin scheduler, fetches Nattrak and reconciles every flight
+            void poll(const std::atomic<bool> &cancelled);
+            Scheduler::JobId pollerJob_ = 0;
+            std::atomic<bool> pollerRunning_ = false;
+            RateLimiter::AdaptiveInterval pollingInterval_;
+
+            // Dirty job, only recomputes the flights reported by the SDK events from their current
+            // SDK data, without taking a new snapshot
+            void processDirty(const std::atomic<bool> &cancelled);
+            Scheduler::JobId dirtyJob_ = 0;
+            DirtySet::DirtySet dirtyCallsigns_;
+
+            // When the dirty job last evaluated a flight. A poll working on an older snapshot
+            // leaves these flags alone.
+            std::unordered_map<Interner::Id, std::chrono::steady_clock::time_point> refreshedAt_;
+
+            // Flag of a single changed flight from the current clearances
+            void evaluateFlight(const ClearanceIndex &clearances, const PluginSDK::Flightplan::Flightplan &flightplan);
 
-            // Thread for the poller
-            void pollerThread();
-            std::thread pollerThread_;
-            bool poolerRunning_ = false;
+            // Controller data is only read for flights with a clearance, the flag is unknown without it
+            static std::optional<PublishedFlag> computeFlag(const IcaoClassifier::IcaoClassifier &oceanicDestinations,
+                const PluginSDK::Flightplan::Flightplan &flightplan, const RouteGeometry &geometry, const Clearance *clearance,
+                const PluginSDK::ControllerData::ControllerDataModel *controllerData, const PluginSDK::Aircraft::Aircraft *aircraft);
+
+            // Every flight plan of the snapshot, in snapshot order, by chunks of EVALUATION_CHUNK_SIZE
+            // on up to evaluationThreads_ threads. Only reads the module state, the results are
+            // incomplete when cancelled.
+            void evaluateFlights(const Snapshot::Snapshot &snapshot, const ClearanceIndex &clearances, const std::atomic<bool> &cancelled,
+                std::vector<FlightEvaluation> &evaluations) const;
+            std::vector<FlightEvaluation> evaluations_; // Reused by every poll
+            size_t evaluationThreads_;
             
-            // List of clearance from the API
-            nlohmann::json getNattrakData(void);
-            nlohmann::json nattrakData_;
+            // List of clearance from the API, indexed by callsign.
+            // Returns nothing when the fetch failed or the payload is unchanged.
+            std::optional<std::vector<Clearance>> getNattrakData(void);
+            static std::shared_ptr<const ClearanceIndex> buildClearanceIndex(std::vector<Clearance> clearanceList);
+            std::shared_ptr<const ClearanceIndex> getClearances(void);
+            std::shared_ptr<const ClearanceIndex> clearances_ = std::make_shared<const ClearanceIndex>();
+            std::mutex clearancesMutex_;
+            std::string nattrakETag_;
+            std::string nattrakLastModified_;
+
+            // Last known clearances, served until Nattrak answers
+            void restoreFromDiskCache(void);
+            void saveClearances(const std::vector<Clearance> &clearanceList);
+            static std::vector<DiskCache::Record> toRecords(const std::vector<Clearance> &clearanceList);
+            static std::vector<Clearance> fromRecords(const std::vector<DiskCache::Record> &records);
+
+            // Clearances published by the fetcher instance of the host
+            uint64_t sharedClearancesSequence_ = 0;
+
+            // Callsigns and route fixes. Interning is thread-safe, the evaluation chunks intern
+            // the fixes of the routes they parse.
+            mutable Interner::Interner names_;
+
+            // Route geometry of each flight, rebuilt only when its route changes
+            std::unordered_map<Interner::Id, RouteGeometry> routeGeometries_;
+            const RouteGeometry &getRouteGeometry(const PluginSDK::Flightplan::Flightplan &flightplan);
+            RouteGeometry buildRouteGeometry(const PluginSDK::Flightplan::Flightplan &flightplan, size_t routeHash) const;
+            static std::optional<std::chrono::seconds> timeToExit(const RouteGeometry &geometry, const PluginSDK::Aircraft::Aircraft &aircraft);
+
+            // Flags currently shown, only real changes are sent to the tag
+            std::unordered_map<Interner::Id, PublishedFlag> publishedFlags_;
 
-            // Function to assign a gate based on flightplan data
-            void updateOceanicFlag(std::string callsign, std::string value, std::array<unsigned int, 3> colour);
-            bool hasOceanicClearance(std::string callsign);
-            int getOceanicFlightLevel(std::string callsign);
+            // Held by the poller, on the worker pool, and the dirty job, on the scheduler,
+            // while they read or update routeGeometries_ and publishedFlags_
+            std::mutex evaluationMutex_;
 
-            // Helper functions
-            bool stringContainsValue(const std::string &str, const std::vector<std::string> &values);
+            // Send a flag to the tag unless it is already shown
+            void updateOceanicFlag(Interner::Id callsign, const std::string &value, const std::array<unsigned int, 3> &colour);
+            static const Clearance *findClearance(const ClearanceIndex &clearances, const std::string &callsign);
     };
 }
\ No newline at end of file
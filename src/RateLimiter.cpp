@@ -0,0 +1,78 @@
+// RateLimiter.cpp
+#include <algorithm>
+#include <charconv>
+#include "RateLimiter.h"
+
+namespace RateLimiter
+{
+    std::optional<std::chrono::seconds> parseRetryAfter(const std::string &value)
+    {
+        long long seconds = 0;
+        auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), seconds);
+        if (value.empty() || error != std::errc() || end != value.data() + value.size() || seconds < 0)
+        {
+            return std::nullopt;
+        }
+        return std::min(std::chrono::seconds(seconds), MAX_RETRY_AFTER);
+    }
+
+    TokenBucket::TokenBucket(const std::string &name, double requestsPerMinute, double burst, AsyncLogger::AsyncLogger &logger, Metrics::Registry &metrics)
+        : name_(name),
+          tokensPerSecond_(requestsPerMinute / 60.0),
+          burst_(std::max(1.0, burst)),
+          logger_(logger),
+          rejected_(metrics.counter(name + ".rate_limited")),
+          tokens_(burst_),
+          lastRefill_(std::chrono::steady_clock::now())
+    {
+    }
+
+    bool TokenBucket::tryAcquire(void)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = std::chrono::steady_clock::now();
+        tokens_ = std::min(burst_, tokens_ + std::chrono::duration<double>(now - lastRefill_).count() * tokensPerSecond_);
+        lastRefill_ = now;
+
+        if (now < pausedUntil_ || tokens_ < 1.0)
+        {
+            rejected_.add();
+            return false;
+        }
+        tokens_ -= 1.0;
+        return true;
+    }
+
+    void TokenBucket::recordResponse(int status, const std::string &retryAfter)
+    {
+        // 503 only counts as a back-off request when the server says for how long
+        auto delay = parseRetryAfter(retryAfter);
+        if (status != 429 && !(status == 503 && delay))
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        pausedUntil_ = std::max(pausedUntil_, std::chrono::steady_clock::now() + delay.value_or(DEFAULT_RETRY_AFTER));
+        tokens_ = 0;
+        logger_.warning(AsyncLogger::Category::General, "{} asked to back off for {} s", name_, delay.value_or(DEFAULT_RETRY_AFTER).count());
+    }
+
+    AdaptiveInterval::AdaptiveInterval(std::chrono::milliseconds minimum, std::chrono::milliseconds maximum)
+        : minimum_(minimum),
+          maximum_(std::max(minimum, maximum)),
+          current_(minimum)
+    {
+    }
+
+    void AdaptiveInterval::recordChanged(void)
+    {
+        current_ = minimum_;
+    }
+
+    void AdaptiveInterval::recordUnchanged(void)
+    {
+        auto grown = std::chrono::milliseconds(static_cast<long long>(current_.count() * INTERVAL_GROWTH));
+        current_ = std::min(maximum_, grown);
+    }
+}
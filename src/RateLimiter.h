@@ -0,0 +1,61 @@
+// RateLimiter.h
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <NeoRadarSDK/SDK.h>
+#include "AsyncLogger.h"
+#include "Metrics.h"
+
+namespace RateLimiter
+{
+    const std::chrono::seconds DEFAULT_RETRY_AFTER = std::chrono::seconds(60); // 429 without a usable Retry-After
+    const std::chrono::seconds MAX_RETRY_AFTER = std::chrono::minutes(10);
+    const double INTERVAL_GROWTH = 1.5; // Applied to the interval after each unchanged payload
+
+    // Delay of a Retry-After header in delta-seconds form, HTTP dates are not supported
+    std::optional<std::chrono::seconds> parseRetryAfter(const std::string &value);
+
+    // Request budget of one external API, shared by all its endpoints.
+    // Refills at a steady rate up to a burst size, and stops granting anything while the server asked to back off.
+    class TokenBucket
+    {
+        public:
+            TokenBucket(const std::string &name, double requestsPerMinute, double burst, AsyncLogger::AsyncLogger &logger, Metrics::Registry &metrics);
+
+            bool tryAcquire(void);
+
+            // Honour 429 and 503 answers, retryAfter is the raw header value
+            void recordResponse(int status, const std::string &retryAfter);
+
+        private:
+            std::string name_;
+            double tokensPerSecond_;
+            double burst_;
+            AsyncLogger::AsyncLogger &logger_;
+            Metrics::Counter &rejected_;
+
+            std::mutex mutex_;
+            double tokens_;
+            std::chrono::steady_clock::time_point lastRefill_;
+            std::chrono::steady_clock::time_point pausedUntil_;
+    };
+
+    // Polling interval following the change rate of a payload: back to the minimum
+    // as soon as it changes, growing by INTERVAL_GROWTH up to the maximum while it does not.
+    class AdaptiveInterval
+    {
+        public:
+            AdaptiveInterval(std::chrono::milliseconds minimum, std::chrono::milliseconds maximum);
+
+            void recordChanged(void);
+            void recordUnchanged(void);
+            std::chrono::milliseconds current(void) const { return current_; }
+
+        private:
+            std::chrono::milliseconds minimum_;
+            std::chrono::milliseconds maximum_;
+            std::chrono::milliseconds current_;
+    };
+}
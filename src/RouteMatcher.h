@@ -0,0 +1,162 @@
+// RouteMatcher.h
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+namespace RouteMatcher
+{
+    const size_t MAX_FIX_LENGTH = 8; // Longest fix name a FixSet can hold
+
+    // Fix found in a route
+    struct Match
+    {
+        std::string_view fix;   // Entry of the fix list that matched
+        size_t tokenIndex;      // Position of the token in the route, counted from 0
+        size_t offset;          // Character offset of the token in the raw route
+    };
+
+    constexpr char toUpper(char c)
+    {
+        return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+    }
+
+    constexpr bool isSeparator(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    // Calls visit(token, tokenIndex, offset) for each token of the route, without the speed and
+    // level change attached with a slash, until visit returns false
+    template <typename Visit>
+    constexpr void forEachToken(std::string_view rawRoute, Visit visit)
+    {
+        size_t tokenIndex = 0;
+        size_t position = 0;
+        while (position < rawRoute.size())
+        {
+            while (position < rawRoute.size() && isSeparator(rawRoute[position]))
+            {
+                position++;
+            }
+            if (position >= rawRoute.size())
+            {
+                return;
+            }
+
+            size_t end = position;
+            while (end < rawRoute.size() && !isSeparator(rawRoute[end]))
+            {
+                end++;
+            }
+
+            std::string_view token = rawRoute.substr(position, end - position);
+            if (!visit(token.substr(0, token.find('/')), tokenIndex, position))
+            {
+                return;
+            }
+            tokenIndex++;
+            position = end;
+        }
+    }
+
+    // FNV-1a over the upper-cased name, mixed with a seed
+    constexpr uint32_t hashFix(std::string_view name, uint32_t seed)
+    {
+        uint32_t hash = 2166136261u ^ seed;
+        for (char c : name)
+        {
+            hash ^= static_cast<uint8_t>(toUpper(c));
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    // Fix list with a collision-free hash table built at compile time.
+    // A lookup is one hash and at most one string comparison.
+    template <size_t N>
+    class FixSet
+    {
+        public:
+            static constexpr size_t TABLE_SIZE = std::bit_ceil(N * 4);
+
+            consteval explicit FixSet(const std::array<std::string_view, N> &fixes)
+            {
+                for (const auto &fix : fixes)
+                {
+                    if (fix.empty() || fix.size() > MAX_FIX_LENGTH)
+                    {
+                        throw std::invalid_argument("Fix name length out of range");
+                    }
+                }
+
+                // Search for a seed without collisions, giving a perfect hash
+                for (uint32_t seed = 0; seed < 10000; seed++)
+                {
+                    std::array<std::string_view, TABLE_SIZE> table{};
+                    bool collision = false;
+                    for (const auto &fix : fixes)
+                    {
+                        auto &slot = table[hashFix(fix, seed) & (TABLE_SIZE - 1)];
+                        if (!slot.empty())
+                        {
+                            collision = true;
+                            break;
+                        }
+                        slot = fix;
+                    }
+                    if (!collision)
+                    {
+                        seed_ = seed;
+                        table_ = table;
+                        return;
+                    }
+                }
+                throw std::logic_error("No perfect hash seed found");
+            }
+
+            // Case-insensitive lookup of a single token
+            constexpr std::optional<std::string_view> find(std::string_view token) const
+            {
+                if (token.empty() || token.size() > MAX_FIX_LENGTH)
+                {
+                    return std::nullopt;
+                }
+                const std::string_view &candidate = table_[hashFix(token, seed_) & (TABLE_SIZE - 1)];
+                if (candidate.size() != token.size())
+                {
+                    return std::nullopt;
+                }
+                for (size_t i = 0; i < token.size(); i++)
+                {
+                    if (toUpper(token[i]) != candidate[i])
+                    {
+                        return std::nullopt;
+                    }
+                }
+                return candidate;
+            }
+
+            // First fix of the list appearing as a route token, e.g. "REGHI" or "REGHI/N0450F350"
+            constexpr std::optional<Match> findFirst(std::string_view rawRoute) const
+            {
+                std::optional<Match> match;
+                forEachToken(rawRoute, [this, &match](std::string_view token, size_t tokenIndex, size_t offset)
+                {
+                    if (auto fix = find(token))
+                    {
+                        match = Match{*fix, tokenIndex, offset};
+                    }
+                    return !match;
+                });
+                return match;
+            }
+
+        private:
+            std::array<std::string_view, TABLE_SIZE> table_{};
+            uint32_t seed_ = 0;
+    };
+}
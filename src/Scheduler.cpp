@@ -0,0 +1,225 @@
+// Scheduler.cpp
+#include <algorithm>
+#include "Scheduler.h"
+
+namespace Scheduler
+{
+    namespace
+    {
+        // Job run by the current thread, a task cancelling itself must not wait for its own return
+        thread_local const void *currentJob = nullptr;
+    }
+
+    Scheduler::Scheduler(size_t threadCount)
+        : threadCount_(std::max<size_t>(1, threadCount)),
+          random_(std::random_device()())
+    {
+    }
+
+    Scheduler::~Scheduler()
+    {
+        stop();
+    }
+
+    void Scheduler::start(void)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_)
+        {
+            running_ = true;
+            for (size_t i = 0; i < threadCount_; i++)
+            {
+                threads_.emplace_back(&Scheduler::run, this);
+            }
+        }
+    }
+
+    void Scheduler::stop(void)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_)
+            {
+                return;
+            }
+            running_ = false;
+            for (auto &[id, job] : jobs_)
+            {
+                job->cancelled = true;
+            }
+        }
+        wakeup_.notify_all();
+        for (auto &thread : threads_)
+        {
+            thread.join();
+        }
+        threads_.clear();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        jobDone_.wait(lock, [this]() { return pooledRuns_ == 0; });
+    }
+
+    JobId Scheduler::addJob(
+        const std::string &name,
+        std::chrono::milliseconds period,
+        std::chrono::milliseconds jitter,
+        Task task,
+        std::chrono::milliseconds initialDelay
+    )
+    {
+        return add(name, period, jitter, nullptr, std::move(task), initialDelay);
+    }
+
+    JobId Scheduler::addBlockingJob(
+        const std::string &name,
+        std::chrono::milliseconds period,
+        std::chrono::milliseconds jitter,
+        WorkerPool::WorkerPool &pool,
+        Task task,
+        std::chrono::milliseconds initialDelay
+    )
+    {
+        return add(name, period, jitter, &pool, std::move(task), initialDelay);
+    }
+
+    JobId Scheduler::add(const std::string &name, std::chrono::milliseconds period, std::chrono::milliseconds jitter,
+        WorkerPool::WorkerPool *pool, Task task, std::chrono::milliseconds initialDelay)
+    {
+        auto job = std::make_shared<Job>();
+        job->name = name;
+        job->period = period;
+        job->jitter = jitter;
+        job->task = std::move(task);
+        job->pool = pool;
+        job->nextRun = std::chrono::steady_clock::now() + initialDelay;
+
+        JobId id;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            id = nextJobId_++;
+            job->id = id;
+            jobs_.emplace(id, std::move(job));
+        }
+        wakeup_.notify_all();
+        return id;
+    }
+
+    void Scheduler::cancelJob(JobId id)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = jobs_.find(id);
+        if (it == jobs_.end())
+        {
+            return;
+        }
+        std::shared_ptr<Job> job = it->second;
+        job->cancelled = true;
+        jobs_.erase(it);
+        wakeup_.notify_all();
+
+        if (job.get() != currentJob)
+        {
+            jobDone_.wait(lock, [&job]() { return !job->running; });
+        }
+    }
+
+    void Scheduler::setPeriod(JobId id, std::chrono::milliseconds period)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = jobs_.find(id);
+            if (it == jobs_.end())
+            {
+                return;
+            }
+            it->second->period = period;
+
+            // A waiting job is pulled in when the new period is shorter
+            auto latest = std::chrono::steady_clock::now() + period;
+            if (!it->second->running && it->second->nextRun > latest)
+            {
+                it->second->nextRun = latest;
+            }
+        }
+        wakeup_.notify_all();
+    }
+
+    void Scheduler::run(void)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (running_)
+        {
+            // Pick the job due first among those not already running on another thread
+            std::shared_ptr<Job> next;
+            for (auto &[id, job] : jobs_)
+            {
+                if (!job->running && (!next || job->nextRun < next->nextRun))
+                {
+                    next = job;
+                }
+            }
+
+            if (!next)
+            {
+                wakeup_.wait(lock);
+                continue;
+            }
+            if (std::chrono::steady_clock::now() < next->nextRun)
+            {
+                // Woken early on add, cancel, stop or the end of a run; the job list is scanned again
+                wakeup_.wait_until(lock, next->nextRun);
+                continue;
+            }
+
+            next->running = true;
+            if (next->pool)
+            {
+                // The run ends on the pool thread, this one goes back to the timers
+                pooledRuns_++;
+                lock.unlock();
+                next->pool->submit([this, next]()
+                {
+                    execute(*next);
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    pooledRuns_--;
+                    finished(*next);
+                });
+                lock.lock();
+                continue;
+            }
+            lock.unlock();
+            execute(*next);
+            lock.lock();
+            finished(*next);
+        }
+    }
+
+    void Scheduler::execute(Job &job)
+    {
+        currentJob = &job;
+        try
+        {
+            job.task(job.cancelled);
+        }
+        catch (const std::exception &) {}
+        currentJob = nullptr;
+    }
+
+    void Scheduler::finished(Job &job)
+    {
+        job.running = false;
+        job.nextRun = std::chrono::steady_clock::now() + jittered(job.period, job.jitter);
+        jobDone_.notify_all();
+        wakeup_.notify_all();
+    }
+
+    std::chrono::milliseconds Scheduler::jittered(std::chrono::milliseconds period, std::chrono::milliseconds jitter)
+    {
+        if (jitter.count() <= 0)
+        {
+            return period;
+        }
+        std::uniform_int_distribution<long long> distribution(-jitter.count(), jitter.count());
+        return std::max(std::chrono::milliseconds(0), period + std::chrono::milliseconds(distribution(random_)));
+    }
+}
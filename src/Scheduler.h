@@ -0,0 +1,95 @@
+// Scheduler.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "WorkerPool.h"
+
+namespace Scheduler
+{
+    const size_t DEFAULT_THREAD_COUNT = 1; // Short jobs only, blocking ones run on a worker pool
+
+    using JobId = uint64_t;
+    using Task = std::function<void(const std::atomic<bool> &cancelled)>;
+
+    // Plugin-wide timer running periodic jobs. Short jobs run on the scheduler threads,
+    // jobs waiting on network I/O are handed to a worker pool so they never hold back
+    // the short ones due meanwhile. A job never overlaps itself; tasks should poll
+    // `cancelled` to return early.
+    class Scheduler
+    {
+        public:
+            explicit Scheduler(size_t threadCount = DEFAULT_THREAD_COUNT);
+            ~Scheduler();
+
+            void start(void);
+
+            // Cancel every job and wait for the runs in progress, on the pools too
+            void stop(void);
+
+            // Run task every period, each run shifted by up to +/- jitter
+            JobId addJob(
+                const std::string &name,
+                std::chrono::milliseconds period,
+                std::chrono::milliseconds jitter,
+                Task task,
+                std::chrono::milliseconds initialDelay = std::chrono::milliseconds(0)
+            );
+
+            // Same, each run being submitted to pool instead of taking a scheduler thread
+            JobId addBlockingJob(
+                const std::string &name,
+                std::chrono::milliseconds period,
+                std::chrono::milliseconds jitter,
+                WorkerPool::WorkerPool &pool,
+                Task task,
+                std::chrono::milliseconds initialDelay = std::chrono::milliseconds(0)
+            );
+
+            // Remove a job and wait for its current run, if any, to return
+            void cancelJob(JobId id);
+
+            // Change the period of a job, applied from its next run. Safe to call from the task itself.
+            void setPeriod(JobId id, std::chrono::milliseconds period);
+
+        private:
+            struct Job
+            {
+                JobId id;
+                std::string name;
+                std::chrono::milliseconds period;
+                std::chrono::milliseconds jitter;
+                Task task;
+                WorkerPool::WorkerPool *pool = nullptr; // Runs on the scheduler threads when null
+                std::chrono::steady_clock::time_point nextRun;
+                bool running = false;
+                std::atomic<bool> cancelled = false;
+            };
+
+            JobId add(const std::string &name, std::chrono::milliseconds period, std::chrono::milliseconds jitter,
+                WorkerPool::WorkerPool *pool, Task task, std::chrono::milliseconds initialDelay);
+            void run(void);
+            static void execute(Job &job);
+            void finished(Job &job); // mutex_ held
+            std::chrono::milliseconds jittered(std::chrono::milliseconds period, std::chrono::milliseconds jitter);
+
+            size_t threadCount_;
+            std::vector<std::thread> threads_;
+            std::mutex mutex_;
+            std::condition_variable wakeup_;
+            std::condition_variable jobDone_;
+            std::map<JobId, std::shared_ptr<Job>> jobs_;
+            JobId nextJobId_ = 1;
+            size_t pooledRuns_ = 0; // Runs submitted to a pool and not returned yet
+            bool running_ = false;
+            std::mt19937 random_;
+    };
+}
@@ -0,0 +1,299 @@
+// SharedCache.cpp
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include "SharedCache.h"
+
+namespace SharedCache
+{
+    namespace
+    {
+        // Written by the fetcher of the section only, sequence is odd while a publish is in progress
+        struct Slot
+        {
+            uint64_t sequence;
+            int64_t publishedAt; // Unix time in seconds
+            uint64_t length;
+            unsigned char data[SLOT_SIZE];
+        };
+
+        const size_t MAP_SIZE = sizeof(Slot) * static_cast<size_t>(Section::Count);
+        const std::array<std::string, static_cast<size_t>(Section::Count)> SECTION_NAMES = {"gate_airports", "gate_stands", "oceanic_clearances", "gate_requests"};
+
+        Slot *slotOf(unsigned char *view, Section section)
+        {
+            return reinterpret_cast<Slot *>(view + sizeof(Slot) * static_cast<size_t>(section));
+        }
+
+        int64_t unixNow(void)
+        {
+            return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    SharedCache::Handle SharedCache::invalidHandle(void)
+    {
+#ifdef _WIN32
+        return INVALID_HANDLE_VALUE;
+#else
+        return -1;
+#endif
+    }
+
+    void SharedCache::closeHandle(Handle handle)
+    {
+        if (handle == invalidHandle())
+        {
+            return;
+        }
+#ifdef _WIN32
+        CloseHandle(handle);
+#else
+        ::close(handle);
+#endif
+    }
+
+    SharedCache::Handle SharedCache::lockFile(const std::filesystem::path &path, bool wait)
+    {
+#ifdef _WIN32
+        Handle handle = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        OVERLAPPED overlapped = {};
+        bool locked = handle != invalidHandle()
+            && LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK | (wait ? 0 : LOCKFILE_FAIL_IMMEDIATELY), 0, 1, 0, &overlapped);
+#else
+        Handle handle = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        bool locked = handle != invalidHandle() && ::flock(handle, LOCK_EX | (wait ? 0 : LOCK_NB)) == 0;
+#endif
+        if (!locked)
+        {
+            closeHandle(handle);
+            return invalidHandle();
+        }
+        return handle;
+    }
+
+    SharedCache::SharedCache(std::filesystem::path directory, AsyncLogger::AsyncLogger &logger)
+        : directory_(std::move(directory)),
+          logger_(logger),
+          mapFile_(invalidHandle())
+    {
+        fetcherLocks_.fill(invalidHandle());
+
+        std::error_code error;
+        std::filesystem::create_directories(directory_, error);
+        std::filesystem::path path = directory_ / SHARED_FILE_NAME;
+
+        // Every instance maps the same file, whoever comes first sizes it
+#ifdef _WIN32
+        mapFile_ = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (mapFile_ != invalidHandle())
+        {
+            ULARGE_INTEGER size;
+            size.QuadPart = MAP_SIZE;
+            mapping_ = CreateFileMappingW(mapFile_, nullptr, PAGE_READWRITE, size.HighPart, size.LowPart, nullptr);
+            if (mapping_)
+            {
+                view_ = static_cast<unsigned char *>(MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, MAP_SIZE));
+            }
+        }
+#else
+        mapFile_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        struct stat status;
+        if (mapFile_ != invalidHandle() && ::fstat(mapFile_, &status) == 0
+            && (static_cast<size_t>(status.st_size) >= MAP_SIZE || ::ftruncate(mapFile_, MAP_SIZE) == 0))
+        {
+            void *view = ::mmap(nullptr, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, mapFile_, 0);
+            if (view != MAP_FAILED)
+            {
+                view_ = static_cast<unsigned char *>(view);
+            }
+        }
+#endif
+
+        if (!view_)
+        {
+            logger_.warning(AsyncLogger::Category::General, "Failed to map {}, this instance fetches everything itself", path.string());
+        }
+    }
+
+    SharedCache::~SharedCache()
+    {
+        for (size_t i = 0; i < fetcherLocks_.size(); i++)
+        {
+            releaseFetcher(static_cast<Section>(i));
+        }
+#ifdef _WIN32
+        if (view_)
+        {
+            UnmapViewOfFile(view_);
+        }
+        if (mapping_)
+        {
+            CloseHandle(mapping_);
+        }
+#else
+        if (view_)
+        {
+            ::munmap(view_, MAP_SIZE);
+        }
+#endif
+        closeHandle(mapFile_);
+    }
+
+    bool SharedCache::acquireFetcher(Section section)
+    {
+        if (!view_)
+        {
+            return true;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        Handle &fetcherLock = fetcherLocks_[static_cast<size_t>(section)];
+        if (fetcherLock != invalidHandle())
+        {
+            return true;
+        }
+
+        Handle handle = lockFile(directory_ / (SECTION_NAMES[static_cast<size_t>(section)] + ".lock"), false);
+        if (handle == invalidHandle())
+        {
+            return false;
+        }
+
+        fetcherLock = handle;
+        logger_.info(AsyncLogger::Category::General, "This instance now fetches {} for the host", SECTION_NAMES[static_cast<size_t>(section)]);
+        return true;
+    }
+
+    void SharedCache::releaseFetcher(Section section)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Handle &fetcherLock = fetcherLocks_[static_cast<size_t>(section)];
+        if (fetcherLock == invalidHandle())
+        {
+            return;
+        }
+
+        // Closing the handle drops the lock
+        closeHandle(fetcherLock);
+        fetcherLock = invalidHandle();
+    }
+
+    void SharedCache::publish(Section section, const std::vector<DiskCache::Record> &records)
+    {
+        if (!view_)
+        {
+            return;
+        }
+
+        std::string payload = DiskCache::encodeRecords(records);
+        if (payload.size() > SLOT_SIZE)
+        {
+            logger_.warning(AsyncLogger::Category::General, "Not sharing {}, {} bytes is over the slot size", SECTION_NAMES[static_cast<size_t>(section)], payload.size());
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot *target = slotOf(view_, section);
+        std::atomic_ref<uint64_t> sequence(target->sequence);
+
+        // An odd sequence was left by a fetcher that died while publishing
+        uint64_t start = sequence.load(std::memory_order_relaxed);
+        start += start & 1;
+        sequence.store(start + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::atomic_ref<int64_t>(target->publishedAt).store(unixNow(), std::memory_order_relaxed);
+        std::atomic_ref<uint64_t>(target->length).store(payload.size(), std::memory_order_relaxed);
+        std::memcpy(target->data, payload.data(), payload.size());
+
+        sequence.store(start + 2, std::memory_order_release);
+    }
+
+    void SharedCache::update(Section section, const std::function<void(std::vector<DiskCache::Record> &records)> &change)
+    {
+        if (!view_)
+        {
+            return;
+        }
+
+        Handle writeLock = lockFile(directory_ / (SECTION_NAMES[static_cast<size_t>(section)] + ".write.lock"), true);
+        if (writeLock == invalidHandle())
+        {
+            logger_.warning(AsyncLogger::Category::General, "Failed to lock {} for writing", SECTION_NAMES[static_cast<size_t>(section)]);
+            return;
+        }
+
+        // No other writer while the lock is held, the slot can be read directly
+        std::vector<DiskCache::Record> records;
+        Slot *source = slotOf(view_, section);
+        uint64_t sequence = std::atomic_ref<uint64_t>(source->sequence).load(std::memory_order_acquire);
+        uint64_t length = std::atomic_ref<uint64_t>(source->length).load(std::memory_order_relaxed);
+        if (sequence != 0 && length <= SLOT_SIZE)
+        {
+            records = DiskCache::decodeRecords(std::string_view(reinterpret_cast<const char *>(source->data), length)).value_or(std::vector<DiskCache::Record>());
+        }
+        change(records);
+        publish(section, records);
+        closeHandle(writeLock);
+    }
+
+    std::optional<std::vector<DiskCache::Record>> SharedCache::readIfNewer(Section section, uint64_t &lastSequence, std::chrono::seconds maxAge)
+    {
+        if (!view_)
+        {
+            return std::nullopt;
+        }
+
+        Slot *source = slotOf(view_, section);
+        std::atomic_ref<uint64_t> sequence(source->sequence);
+        for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++)
+        {
+            uint64_t before = sequence.load(std::memory_order_acquire);
+            if (before == 0 || before == lastSequence)
+            {
+                return std::nullopt;
+            }
+            if (before & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            int64_t publishedAt = std::atomic_ref<int64_t>(source->publishedAt).load(std::memory_order_relaxed);
+            uint64_t length = std::atomic_ref<uint64_t>(source->length).load(std::memory_order_relaxed);
+            if (length > SLOT_SIZE)
+            {
+                continue;
+            }
+            std::string payload(reinterpret_cast<const char *>(source->data), length);
+
+            // Copy is only valid if no publish started meanwhile
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) != before)
+            {
+                continue;
+            }
+
+            lastSequence = before;
+            if (unixNow() - publishedAt > maxAge.count())
+            {
+                return std::nullopt;
+            }
+            return DiskCache::decodeRecords(payload);
+        }
+        return std::nullopt;
+    }
+}
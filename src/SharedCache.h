@@ -0,0 +1,75 @@
+// SharedCache.h
+#pragma once
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include <NeoRadarSDK/SDK.h>
+#include "AsyncLogger.h"
+#include "DiskCache.h"
+
+namespace SharedCache
+{
+    const std::string SHARED_FILE_NAME = "shared-v2.map"; // Under the cache directory
+    const size_t SLOT_SIZE = 256 * 1024; // Largest encoded section
+    const int MAX_READ_ATTEMPTS = 8; // Reads torn by a concurrent publish are retried this many times
+
+    // Data published by one instance for the others
+    enum class Section : size_t
+    {
+        GateAirports,
+        GateStands,
+        OceanicClearances,
+        GateRequests, // Written by every instance, see update()
+        Count
+    };
+
+    // Memory-mapped file shared by every plugin instance on the host.
+    // Each section has a fetcher, elected by an exclusive lock on its lock file: the
+    // operating system releases the lock when the process exits so another instance
+    // takes over on its next poll. The fetcher publishes the records in the section
+    // slot under a seqlock, the other instances read them without any network I/O.
+    class SharedCache
+    {
+        public:
+            SharedCache(std::filesystem::path directory, AsyncLogger::AsyncLogger &logger);
+            ~SharedCache();
+
+            // True while this instance fetches the section, tried again on every call until elected
+            bool acquireFetcher(Section section);
+            void releaseFetcher(Section section);
+
+            void publish(Section section, const std::vector<DiskCache::Record> &records);
+
+            // Read, change and publish the records of a section any instance may write. Writers
+            // take turns on the write lock file of the section, readers only see the seqlock.
+            void update(Section section, const std::function<void(std::vector<DiskCache::Record> &records)> &change);
+
+            // Records published after lastSequence and less than maxAge ago, lastSequence is updated
+            std::optional<std::vector<DiskCache::Record>> readIfNewer(Section section, uint64_t &lastSequence, std::chrono::seconds maxAge);
+
+        private:
+            std::filesystem::path directory_;
+            AsyncLogger::AsyncLogger &logger_;
+            std::mutex mutex_;
+
+            // Native file handles, HANDLE on Windows and descriptors elsewhere
+#ifdef _WIN32
+            using Handle = void *;
+            Handle mapping_ = nullptr;
+#else
+            using Handle = int;
+#endif
+            static Handle invalidHandle(void);
+            Handle mapFile_;
+            unsigned char *view_ = nullptr;
+            std::array<Handle, static_cast<size_t>(Section::Count)> fetcherLocks_;
+
+            static void closeHandle(Handle handle);
+            // Exclusive lock on a lock file, invalidHandle() when held elsewhere and wait is false
+            static Handle lockFile(const std::filesystem::path &path, bool wait);
+    };
+}
@@ -0,0 +1,160 @@
+// Snapshot.cpp
+#include "Snapshot.h"
+
+namespace Snapshot
+{
+    Snapshot::Snapshot(
+        std::vector<PluginSDK::Flightplan::Flightplan> flightplans,
+        std::vector<PluginSDK::Aircraft::Aircraft> aircraft,
+        PluginSDK::Aircraft::AircraftAPI &aircraftAPI,
+        PluginSDK::ControllerData::ControllerDataAPI &controllerDataAPI
+    ) : flightplans_(std::move(flightplans)),
+        takenAt_(std::chrono::steady_clock::now()),
+        aircraftAPI_(aircraftAPI),
+        controllerDataAPI_(controllerDataAPI)
+    {
+        flightplanIndex_.reserve(flightplans_.size());
+        for (size_t i = 0; i < flightplans_.size(); i++)
+        {
+            flightplanIndex_.emplace(flightplans_[i].callsign, i);
+        }
+
+        aircraft_.reserve(aircraft.size());
+        for (auto &entry : aircraft)
+        {
+            std::string callsign = entry.callsign;
+            aircraft_.emplace(std::move(callsign), std::move(entry));
+        }
+    }
+
+    const PluginSDK::Flightplan::Flightplan *Snapshot::getFlightplan(const std::string &callsign) const
+    {
+        auto it = flightplanIndex_.find(callsign);
+        return it != flightplanIndex_.end() ? &flightplans_[it->second] : nullptr;
+    }
+
+    const PluginSDK::Aircraft::Aircraft *Snapshot::getAircraft(const std::string &callsign) const
+    {
+        auto it = aircraft_.find(callsign);
+        return it != aircraft_.end() ? &it->second : nullptr;
+    }
+
+    const PluginSDK::ControllerData::ControllerDataModel *Snapshot::getControllerData(const std::string &callsign) const
+    {
+        std::lock_guard<std::mutex> lock(memoMutex_);
+        auto it = controllerData_.find(callsign);
+        if (it == controllerData_.end())
+        {
+            it = controllerData_.emplace(callsign, controllerDataAPI_.getByCallsign(callsign)).first;
+        }
+        return it->second ? &*it->second : nullptr;
+    }
+
+    void Snapshot::getControllerData(const std::vector<const std::string *> &callsigns,
+        std::vector<const PluginSDK::ControllerData::ControllerDataModel *> &controllerData) const
+    {
+        controllerData.assign(callsigns.size(), nullptr);
+        std::vector<size_t> missing;
+        {
+            std::lock_guard<std::mutex> lock(memoMutex_);
+            for (size_t i = 0; i < callsigns.size(); i++)
+            {
+                auto it = controllerData_.find(*callsigns[i]);
+                if (it == controllerData_.end())
+                {
+                    missing.push_back(i);
+                }
+                else if (it->second)
+                {
+                    controllerData[i] = &*it->second;
+                }
+            }
+        }
+        if (missing.empty())
+        {
+            return;
+        }
+
+        std::vector<std::optional<PluginSDK::ControllerData::ControllerDataModel>> fetched;
+        fetched.reserve(missing.size());
+        for (size_t i : missing)
+        {
+            fetched.push_back(controllerDataAPI_.getByCallsign(*callsigns[i]));
+        }
+
+        // A callsign memoized meanwhile by another reader keeps its first value
+        std::lock_guard<std::mutex> lock(memoMutex_);
+        for (size_t j = 0; j < missing.size(); j++)
+        {
+            auto it = controllerData_.try_emplace(*callsigns[missing[j]], std::move(fetched[j])).first;
+            controllerData[missing[j]] = it->second ? &*it->second : nullptr;
+        }
+    }
+
+    std::optional<double> Snapshot::getDistanceToDestination(const std::string &callsign) const
+    {
+        std::lock_guard<std::mutex> lock(memoMutex_);
+        auto it = distancesToDestination_.find(callsign);
+        if (it == distancesToDestination_.end())
+        {
+            it = distancesToDestination_.emplace(callsign, aircraftAPI_.getDistanceToDestination(callsign)).first;
+        }
+        return it->second;
+    }
+
+    SnapshotProvider::SnapshotProvider(
+        PluginSDK::Aircraft::AircraftAPI &aircraftAPI,
+        PluginSDK::Flightplan::FlightplanAPI &flightplanAPI,
+        PluginSDK::ControllerData::ControllerDataAPI &controllerDataAPI,
+        std::chrono::milliseconds maxAge
+    ) : aircraftAPI_(aircraftAPI),
+        flightplanAPI_(flightplanAPI),
+        controllerDataAPI_(controllerDataAPI),
+        maxAge_(maxAge)
+    {
+    }
+
+    std::shared_ptr<const Snapshot> SnapshotProvider::take(void)
+    {
+        // Built outside the lock, readers keep getting the previous one meanwhile
+        auto snapshot = build();
+        std::lock_guard<std::mutex> lock(mutex_);
+        snapshot_ = snapshot;
+        return snapshot;
+    }
+
+    std::shared_ptr<const Snapshot> SnapshotProvider::get(void)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!snapshot_ || std::chrono::steady_clock::now() - snapshot_->takenAt() > maxAge_)
+        {
+            snapshot_ = build();
+        }
+        return snapshot_;
+    }
+
+    std::shared_ptr<const Snapshot> SnapshotProvider::build(void)
+    {
+        return std::make_shared<const Snapshot>(
+            flightplanAPI_.getAll(),
+            aircraftAPI_.getAll(),
+            aircraftAPI_,
+            controllerDataAPI_
+        );
+    }
+
+    std::optional<PluginSDK::Flightplan::Flightplan> SnapshotProvider::fetchFlightplan(const std::string &callsign)
+    {
+        return flightplanAPI_.getByCallsign(callsign);
+    }
+
+    std::optional<PluginSDK::Aircraft::Aircraft> SnapshotProvider::fetchAircraft(const std::string &callsign)
+    {
+        return aircraftAPI_.getByCallsign(callsign);
+    }
+
+    std::optional<PluginSDK::ControllerData::ControllerDataModel> SnapshotProvider::fetchControllerData(const std::string &callsign)
+    {
+        return controllerDataAPI_.getByCallsign(callsign);
+    }
+}
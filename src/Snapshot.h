@@ -0,0 +1,91 @@
+// Snapshot.h
+#pragma once
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <NeoRadarSDK/SDK.h>
+
+namespace Snapshot
+{
+    const std::chrono::milliseconds SNAPSHOT_MAX_AGE = std::chrono::seconds(6); // One gate tick with its jitter
+
+    // Immutable view of the traffic at one instant, shared by all modules until the next tick.
+    // Controller data and distances are fetched on first use and memoized for the snapshot lifetime.
+    class Snapshot
+    {
+        public:
+            Snapshot(
+                std::vector<PluginSDK::Flightplan::Flightplan> flightplans,
+                std::vector<PluginSDK::Aircraft::Aircraft> aircraft,
+                PluginSDK::Aircraft::AircraftAPI &aircraftAPI,
+                PluginSDK::ControllerData::ControllerDataAPI &controllerDataAPI
+            );
+
+            const std::vector<PluginSDK::Flightplan::Flightplan> &flightplans() const { return flightplans_; }
+            std::chrono::steady_clock::time_point takenAt() const { return takenAt_; }
+
+            const PluginSDK::Flightplan::Flightplan *getFlightplan(const std::string &callsign) const;
+
+            const PluginSDK::Aircraft::Aircraft *getAircraft(const std::string &callsign) const;
+            const PluginSDK::ControllerData::ControllerDataModel *getControllerData(const std::string &callsign) const;
+
+            // Same for several callsigns with two memo lookups, the SDK being called outside the lock.
+            // Lets parallel readers fetch a whole chunk without queuing on each other.
+            void getControllerData(const std::vector<const std::string *> &callsigns,
+                std::vector<const PluginSDK::ControllerData::ControllerDataModel *> &controllerData) const;
+
+            std::optional<double> getDistanceToDestination(const std::string &callsign) const;
+
+        private:
+            std::vector<PluginSDK::Flightplan::Flightplan> flightplans_;
+            std::unordered_map<std::string_view, size_t> flightplanIndex_; // Views into flightplans_
+            std::unordered_map<std::string, PluginSDK::Aircraft::Aircraft> aircraft_;
+            std::chrono::steady_clock::time_point takenAt_;
+
+            PluginSDK::Aircraft::AircraftAPI &aircraftAPI_;
+            PluginSDK::ControllerData::ControllerDataAPI &controllerDataAPI_;
+            mutable std::mutex memoMutex_;
+            mutable std::unordered_map<std::string, std::optional<PluginSDK::ControllerData::ControllerDataModel>> controllerData_;
+            mutable std::unordered_map<std::string, std::optional<double>> distancesToDestination_;
+    };
+
+    class SnapshotProvider
+    {
+        public:
+            SnapshotProvider(
+                PluginSDK::Aircraft::AircraftAPI &aircraftAPI,
+                PluginSDK::Flightplan::FlightplanAPI &flightplanAPI,
+                PluginSDK::ControllerData::ControllerDataAPI &controllerDataAPI,
+                std::chrono::milliseconds maxAge = SNAPSHOT_MAX_AGE
+            );
+            ~SnapshotProvider() = default;
+
+            // New snapshot from the SDK, for the module whose tick sets the pace. The others get it
+            // until the next one.
+            std::shared_ptr<const Snapshot> take(void);
+
+            // Latest snapshot, taken again from the SDK when older than maxAge, i.e. the ticking
+            // module stopped
+            std::shared_ptr<const Snapshot> get(void);
+
+            // Current state of one flight straight from the SDK, for the flights changed since the
+            // snapshot was taken. The shared snapshot is left alone.
+            std::optional<PluginSDK::Flightplan::Flightplan> fetchFlightplan(const std::string &callsign);
+            std::optional<PluginSDK::Aircraft::Aircraft> fetchAircraft(const std::string &callsign);
+            std::optional<PluginSDK::ControllerData::ControllerDataModel> fetchControllerData(const std::string &callsign);
+
+        private:
+            PluginSDK::Aircraft::AircraftAPI &aircraftAPI_;
+            PluginSDK::Flightplan::FlightplanAPI &flightplanAPI_;
+            PluginSDK::ControllerData::ControllerDataAPI &controllerDataAPI_;
+
+            std::chrono::milliseconds maxAge_;
+            std::mutex mutex_;
+            std::shared_ptr<const Snapshot> snapshot_;
+            std::shared_ptr<const Snapshot> build(void);
+    };
+}
@@ -0,0 +1,159 @@
+// StandAllocator.cpp
+#include <algorithm>
+#include <toml.hpp>
+#include "StandAllocator.h"
+
+namespace StandAllocator
+{
+    namespace
+    {
+        bool matchesPrefix(const std::vector<std::string> &prefixes, const std::string &value)
+        {
+            return std::any_of(prefixes.begin(), prefixes.end(), [&value](const std::string &prefix) { return value.starts_with(prefix); });
+        }
+    }
+
+    StandAllocator::StandAllocator(AsyncLogger::AsyncLogger &logger)
+        : logger_(logger)
+    {
+    }
+
+    bool StandAllocator::load(const std::filesystem::path &path)
+    {
+        std::unordered_map<std::string, std::vector<Stand>> airports;
+        try {
+            toml::value data = toml::parse(path.string());
+            for (const auto &entry : data.at("stands").as_array())
+            {
+                Stand stand;
+                stand.name = toml::find<std::string>(entry, "name");
+                stand.wakeCategories = toml::find_or<std::vector<std::string>>(entry, "wake", std::vector<std::string>());
+                stand.airlines = toml::find_or<std::vector<std::string>>(entry, "airlines", std::vector<std::string>());
+                stand.origins = toml::find_or<std::vector<std::string>>(entry, "origins", std::vector<std::string>());
+                airports[toml::find<std::string>(entry, "airport")].push_back(std::move(stand));
+            }
+        }
+        catch (const std::exception &err)
+        {
+            logger_.error(AsyncLogger::Category::Gate, "Failed to parse {}: {}", path.string(), err.what());
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        airports_ = std::move(airports);
+        reservations_.clear();
+        logger_.info(AsyncLogger::Category::Gate, "Loaded local stands for {} airports from {}", airports_.size(), path.string());
+        return true;
+    }
+
+    bool StandAllocator::covers(const std::string &airport) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return airports_.contains(airport);
+    }
+
+    std::optional<std::string> StandAllocator::allocate(const std::string &callsign, const std::string &airport, const std::string &origin, const std::string &wakeCategory, TimePoint onBlock)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto stands = airports_.find(airport);
+        if (stands == airports_.end())
+        {
+            return std::nullopt;
+        }
+        releaseLocked(callsign);
+
+        // Airline preference first, then origin, ties go to the first stand of the file
+        std::optional<size_t> best;
+        int bestScore = -1;
+        for (size_t i = 0; i < stands->second.size() && bestScore < 3; i++)
+        {
+            const Stand &stand = stands->second[i];
+            if (!stand.wakeCategories.empty() && std::find(stand.wakeCategories.begin(), stand.wakeCategories.end(), wakeCategory) == stand.wakeCategories.end())
+            {
+                continue;
+            }
+            int score = (matchesPrefix(stand.airlines, callsign) ? 2 : 0) + (matchesPrefix(stand.origins, origin) ? 1 : 0);
+            if (score > bestScore && isFree(stand, onBlock))
+            {
+                best = i;
+                bestScore = score;
+            }
+        }
+        if (!best)
+        {
+            return std::nullopt;
+        }
+
+        Stand &stand = stands->second[*best];
+        stand.occupations.emplace(onBlock, callsign);
+        reservations_[callsign] = Reservation{airport, *best, onBlock, true};
+        return stand.name;
+    }
+
+    std::vector<std::string> StandAllocator::confirm(const std::string &callsign, const std::string &airport, const std::string &stand, TimePoint onBlock)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        releaseLocked(callsign);
+        auto stands = airports_.find(airport);
+        if (stands == airports_.end())
+        {
+            return {};
+        }
+        auto confirmed = std::find_if(stands->second.begin(), stands->second.end(), [&stand](const Stand &candidate) { return candidate.name == stand; });
+        if (confirmed == stands->second.end())
+        {
+            return {};
+        }
+
+        // Provisional occupations overlapping the confirmed one give way
+        std::vector<std::string> bumped;
+        for (auto it = confirmed->occupations.upper_bound(onBlock - OCCUPATION_TIME); it != confirmed->occupations.end() && it->first < onBlock + OCCUPATION_TIME; ++it)
+        {
+            if (reservations_.at(it->second).provisional)
+            {
+                bumped.push_back(it->second);
+            }
+        }
+        for (const auto &other : bumped)
+        {
+            releaseLocked(other);
+        }
+
+        confirmed->occupations.emplace(onBlock, callsign);
+        reservations_[callsign] = Reservation{airport, static_cast<size_t>(confirmed - stands->second.begin()), onBlock, false};
+        return bumped;
+    }
+
+    void StandAllocator::release(const std::string &callsign)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        releaseLocked(callsign);
+    }
+
+    void StandAllocator::releaseLocked(const std::string &callsign)
+    {
+        auto reservation = reservations_.find(callsign);
+        if (reservation == reservations_.end())
+        {
+            return;
+        }
+        auto &occupations = airports_.at(reservation->second.airport)[reservation->second.stand].occupations;
+        auto [first, last] = occupations.equal_range(reservation->second.onBlock);
+        for (auto it = first; it != last; ++it)
+        {
+            if (it->second == callsign)
+            {
+                occupations.erase(it);
+                break;
+            }
+        }
+        reservations_.erase(reservation);
+    }
+
+    bool StandAllocator::isFree(const Stand &stand, TimePoint onBlock) const
+    {
+        // Occupations all last OCCUPATION_TIME, so an overlap starts less than that before or after
+        auto next = stand.occupations.upper_bound(onBlock - OCCUPATION_TIME);
+        return next == stand.occupations.end() || next->first >= onBlock + OCCUPATION_TIME;
+    }
+}
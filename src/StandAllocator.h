@@ -0,0 +1,70 @@
+// StandAllocator.h
+#pragma once
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "AsyncLogger.h"
+
+namespace StandAllocator
+{
+    const std::string STAND_DATA_FILE_NAME = "CoFrance-stands.toml"; // Looked up next to the plugin library
+    const std::chrono::minutes OCCUPATION_TIME = std::chrono::minutes(60); // From on-block, the same for every stand
+    const std::chrono::minutes TAXI_IN_TIME = std::chrono::minutes(5); // From the threshold to on-block
+
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    // Stand of the data file with the flights it is expected to hold
+    struct Stand
+    {
+        std::string name;
+        std::vector<std::string> wakeCategories; // Accepted wake categories, empty for all
+        std::vector<std::string> airlines; // Preferred callsign prefixes
+        std::vector<std::string> origins; // Preferred origin prefixes
+
+        // On-block time of each occupation, all last OCCUPATION_TIME
+        std::multimap<TimePoint, std::string> occupations;
+    };
+
+    // In-plugin stand allocation for the airports of the data file, answering
+    // while the stand API is slow or down. Local allocations are provisional:
+    // a stand confirmed by the API takes precedence and bumps them.
+    class StandAllocator
+    {
+        public:
+            explicit StandAllocator(AsyncLogger::AsyncLogger &logger);
+
+            // Replace the stands with the ones of a data file, false if it cannot be read
+            bool load(const std::filesystem::path &path);
+            bool covers(const std::string &airport) const;
+
+            // Best free stand for the arrival, reserved provisionally until confirm or release
+            std::optional<std::string> allocate(const std::string &callsign, const std::string &airport, const std::string &origin, const std::string &wakeCategory, TimePoint onBlock);
+
+            // Record the stand given by the API. Returns the callsigns whose provisional stand it took.
+            std::vector<std::string> confirm(const std::string &callsign, const std::string &airport, const std::string &stand, TimePoint onBlock);
+
+            void release(const std::string &callsign);
+
+        private:
+            struct Reservation
+            {
+                std::string airport;
+                size_t stand;
+                TimePoint onBlock;
+                bool provisional;
+            };
+
+            AsyncLogger::AsyncLogger &logger_;
+            mutable std::mutex mutex_;
+            std::unordered_map<std::string, std::vector<Stand>> airports_;
+            std::unordered_map<std::string, Reservation> reservations_;
+
+            void releaseLocked(const std::string &callsign);
+            bool isFree(const Stand &stand, TimePoint onBlock) const;
+    };
+}
@@ -0,0 +1,78 @@
+// TagUpdateQueue.cpp
+#include <algorithm>
+#include <vector>
+#include "TagUpdateQueue.h"
+
+namespace TagUpdateQueue
+{
+    TagUpdateQueue::TagUpdateQueue(PluginSDK::Tag::TagAPI &tagAPI, Metrics::Registry &metrics)
+        : tagAPI_(tagAPI),
+          queued_(metrics.counter("tags.queued")),
+          coalesced_(metrics.counter("tags.coalesced")),
+          dispatched_(metrics.counter("tags.dispatched")),
+          depth_(metrics.gauge("tags.queue_depth")),
+          latency_(metrics.histogram("tags.dispatch_latency_us"))
+    {
+    }
+
+    void TagUpdateQueue::push(const std::string &tagId, const std::string &callsign, const std::string &value,
+        std::optional<std::array<unsigned int, 3>> colour)
+    {
+        Interner::Id tag = names_.intern(tagId);
+        uint64_t key = static_cast<uint64_t>(tag) << 32 | names_.intern(callsign);
+
+        queued_.add();
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto [pending, inserted] = pending_.try_emplace(key);
+        Update &update = pending->second;
+        if (inserted)
+        {
+            update.tagId = tag;
+            update.context.callsign = callsign;
+            update.queuedAt = std::chrono::steady_clock::now();
+            order_.push_back(pending->first);
+        }
+        else
+        {
+            coalesced_.add();
+        }
+        update.value = value;
+        update.context.colour = colour;
+        depth_.set(static_cast<int64_t>(pending_.size()));
+    }
+
+    void TagUpdateQueue::dispatch(void)
+    {
+        batch_.clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            size_t count = std::min(order_.size(), MAX_UPDATES_PER_DISPATCH);
+            batch_.reserve(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                auto pending = pending_.find(order_.front());
+                batch_.push_back(std::move(pending->second));
+                pending_.erase(pending);
+                order_.pop_front();
+            }
+            depth_.set(static_cast<int64_t>(pending_.size()));
+        }
+
+        // Outside the lock, producers are never held up by the client
+        auto now = std::chrono::steady_clock::now();
+        for (const auto &update : batch_)
+        {
+            tagAPI_.getInterface()->UpdateTagValue(names_.name(update.tagId), update.value, update.context);
+            latency_.record(now - update.queuedAt);
+        }
+        dispatched_.add(batch_.size());
+    }
+
+    void TagUpdateQueue::clear(void)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.clear();
+        order_.clear();
+        depth_.set(0);
+    }
+}
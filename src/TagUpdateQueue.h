@@ -0,0 +1,61 @@
+// TagUpdateQueue.h
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <NeoRadarSDK/SDK.h>
+#include "Interner.h"
+#include "Metrics.h"
+
+namespace TagUpdateQueue
+{
+    const std::chrono::milliseconds DISPATCH_INTERVAL = std::chrono::milliseconds(100);
+    const size_t MAX_UPDATES_PER_DISPATCH = 100; // Caps the client at 1000 tag updates per second
+
+    // Tag updates of every module, sent to the client by a single dispatcher job.
+    // Updates of the same tag and callsign still waiting are replaced by the latest one
+    // and keep their place in the queue.
+    class TagUpdateQueue
+    {
+        public:
+            TagUpdateQueue(PluginSDK::Tag::TagAPI &tagAPI, Metrics::Registry &metrics);
+
+            void push(const std::string &tagId, const std::string &callsign, const std::string &value,
+                std::optional<std::array<unsigned int, 3>> colour = std::nullopt);
+
+            // Send up to MAX_UPDATES_PER_DISPATCH updates, oldest first
+            void dispatch(void);
+
+            // Forget the waiting updates, once the tags are gone
+            void clear(void);
+
+        private:
+            struct Update
+            {
+                Interner::Id tagId;
+                std::string value;
+                PluginSDK::Tag::TagContext context;
+                std::chrono::steady_clock::time_point queuedAt;
+            };
+
+            PluginSDK::Tag::TagAPI &tagAPI_;
+            Metrics::Counter &queued_;
+            Metrics::Counter &coalesced_;
+            Metrics::Counter &dispatched_;
+            Metrics::Gauge &depth_;
+            Metrics::Histogram &latency_;
+
+            // Waiting updates keyed by the interned tag id and callsign, order keeps the keys first in first out
+            Interner::Interner names_;
+            std::mutex mutex_;
+            std::unordered_map<uint64_t, Update> pending_;
+            std::deque<uint64_t> order_;
+            std::vector<Update> batch_; // Only touched by the dispatcher, keeps its capacity
+    };
+}
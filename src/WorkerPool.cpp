@@ -0,0 +1,118 @@
+// WorkerPool.cpp
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include "WorkerPool.h"
+
+namespace WorkerPool
+{
+    WorkerPool::WorkerPool(size_t threadCount)
+    {
+        threadCount = std::max<size_t>(1, threadCount);
+        threads_.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; i++)
+        {
+            threads_.emplace_back(&WorkerPool::run, this);
+        }
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wakeup_.notify_all();
+        for (auto &thread : threads_)
+        {
+            thread.join();
+        }
+    }
+
+    void WorkerPool::submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        wakeup_.notify_one();
+    }
+
+    void WorkerPool::parallelFor(size_t count, size_t maxWorkers, const std::function<void(size_t index)> &body)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        // Shared with the helpers, one may only be picked up after all items are done and the caller returned
+        struct Progress
+        {
+            const std::function<void(size_t index)> *body;
+            size_t count;
+            std::atomic<size_t> next = 0;
+            std::mutex mutex;
+            std::condition_variable done;
+            size_t finished = 0;
+        };
+        auto progress = std::make_shared<Progress>();
+        progress->body = &body;
+        progress->count = count;
+
+        auto work = [](Progress &progress)
+        {
+            size_t ran = 0;
+            for (size_t i = progress.next++; i < progress.count; i = progress.next++)
+            {
+                try
+                {
+                    (*progress.body)(i);
+                }
+                catch (const std::exception &) {}
+                ran++;
+            }
+            if (ran > 0)
+            {
+                std::lock_guard<std::mutex> lock(progress.mutex);
+                progress.finished += ran;
+                if (progress.finished == progress.count)
+                {
+                    progress.done.notify_all();
+                }
+            }
+        };
+
+        size_t helpers = std::min({maxWorkers, count, threads_.size() + 1});
+        for (size_t i = 1; i < helpers; i++)
+        {
+            submit([progress, work]() { work(*progress); });
+        }
+        work(*progress);
+
+        std::unique_lock<std::mutex> lock(progress->mutex);
+        progress->done.wait(lock, [&progress]() { return progress->finished == progress->count; });
+    }
+
+    void WorkerPool::run(void)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            wakeup_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty())
+            {
+                return;
+            }
+            std::function<void()> task = std::move(tasks_.front());
+            tasks_.pop_front();
+            lock.unlock();
+            try
+            {
+                task();
+            }
+            catch (const std::exception &) {}
+            lock.lock();
+        }
+    }
+}
@@ -0,0 +1,42 @@
+// WorkerPool.h
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WorkerPool
+{
+    const size_t DEFAULT_THREAD_COUNT = 4;
+
+    // Plugin-wide threads for work that blocks or fans out: stand queries, poller runs, flight
+    // evaluation chunks. Started once and kept across ticks, so a tick never creates threads.
+    class WorkerPool
+    {
+        public:
+            explicit WorkerPool(size_t threadCount = DEFAULT_THREAD_COUNT);
+            ~WorkerPool();
+
+            size_t size(void) const { return threads_.size(); }
+
+            // Run task on a pool thread. Tasks still queued at destruction are run before it returns.
+            void submit(std::function<void()> task);
+
+            // Call body(0) .. body(count - 1) on at most maxWorkers threads, the caller being one of
+            // them, and return once every call returned. The caller keeps taking items, so this
+            // finishes even when every pool thread is busy, including from a pool thread.
+            void parallelFor(size_t count, size_t maxWorkers, const std::function<void(size_t index)> &body);
+
+        private:
+            void run(void);
+
+            std::vector<std::thread> threads_;
+            std::mutex mutex_;
+            std::condition_variable wakeup_;
+            std::deque<std::function<void()>> tasks_;
+            bool stopping_ = false;
+    };
+}
@@ -0,0 +1,139 @@
+// AsyncLoggerTest.cpp
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "AsyncLogger.h"
+#include "FakeSdk.h"
+#include "Metrics.h"
+
+namespace
+{
+    class AsyncLoggerTest : public ::testing::Test
+    {
+        protected:
+            // Lines forwarded to the SDK logger once everything recorded is drained
+            std::vector<std::string> drained(void)
+            {
+                asyncLogger.drain();
+                return logger.lines();
+            }
+
+            FakeSdk::Logger logger;
+            Metrics::Registry metrics;
+            AsyncLogger::AsyncLogger asyncLogger{logger, metrics};
+    };
+}
+
+TEST_F(AsyncLoggerTest, PlaceholdersTakeTheArgumentsInOrder)
+{
+    asyncLogger.info(AsyncLogger::Category::General, "{} stands at {}, {} free", 12, std::string("LFPG"), 2.5);
+    asyncLogger.info(AsyncLogger::Category::General, "enabled {} level {}", true, AsyncLogger::Level::Warning);
+    asyncLogger.info(AsyncLogger::Category::General, "missing {} and {}", -3);
+    asyncLogger.info(AsyncLogger::Category::General, "no placeholder", 1, 2);
+    asyncLogger.info(AsyncLogger::Category::General, "braces { } {x} {{}");
+    asyncLogger.info(AsyncLogger::Category::General, "{}{}", "a", "b");
+    EXPECT_EQ(drained(), std::vector<std::string>({
+        "info: 12 stands at LFPG, 2.5 free",
+        "info: enabled true level 2",
+        "info: missing -3 and {}",
+        "info: no placeholder",
+        "info: braces { } {x} {{}",
+        "info: ab"}));
+}
+
+TEST_F(AsyncLoggerTest, LevelsAreSetPerCategory)
+{
+    asyncLogger.setLevel(AsyncLogger::Category::General, AsyncLogger::Level::Debug);
+    asyncLogger.setLevel(AsyncLogger::Category::Gate, AsyncLogger::Level::Warning);
+    asyncLogger.setLevel(AsyncLogger::Category::Oceanic, AsyncLogger::Level::Off);
+    EXPECT_TRUE(asyncLogger.enabled(AsyncLogger::Category::General, AsyncLogger::Level::Debug));
+    EXPECT_FALSE(asyncLogger.enabled(AsyncLogger::Category::Gate, AsyncLogger::Level::Info));
+    EXPECT_FALSE(asyncLogger.enabled(AsyncLogger::Category::Oceanic, AsyncLogger::Level::Error));
+
+    asyncLogger.debug(AsyncLogger::Category::General, "general debug");
+    asyncLogger.info(AsyncLogger::Category::Gate, "gate info");
+    asyncLogger.warning(AsyncLogger::Category::Gate, "gate warning");
+    asyncLogger.error(AsyncLogger::Category::Gate, "gate error");
+    asyncLogger.error(AsyncLogger::Category::Oceanic, "oceanic error");
+    EXPECT_EQ(drained(), std::vector<std::string>({"info: general debug", "warning: gate warning", "error: gate error"}));
+
+    EXPECT_EQ(AsyncLogger::parseLevel("warning"), AsyncLogger::Level::Warning);
+    EXPECT_EQ(AsyncLogger::parseLevel("off"), AsyncLogger::Level::Off);
+    EXPECT_EQ(AsyncLogger::parseLevel("WARNING"), std::nullopt);
+    EXPECT_EQ(AsyncLogger::parseCategory("oceanic"), AsyncLogger::Category::Oceanic);
+    EXPECT_EQ(AsyncLogger::parseCategory("stands"), std::nullopt);
+}
+
+TEST_F(AsyncLoggerTest, FullRingDropsNewEntriesAndCountsThem)
+{
+    const size_t extra = 100;
+    for (size_t i = 0; i < AsyncLogger::RING_CAPACITY + extra; i++)
+    {
+        asyncLogger.info(AsyncLogger::Category::General, "line {}", i);
+    }
+    EXPECT_EQ(metrics.counter("log.dropped").value(), extra);
+
+    // The oldest entries are kept, the ones that found the ring full are lost
+    auto lines = drained();
+    ASSERT_EQ(lines.size(), AsyncLogger::RING_CAPACITY);
+    EXPECT_EQ(lines.front(), "info: line 0");
+    EXPECT_EQ(lines.back(), "info: line " + std::to_string(AsyncLogger::RING_CAPACITY - 1));
+
+    // Drained cells are free again
+    asyncLogger.info(AsyncLogger::Category::General, "after drain");
+    EXPECT_EQ(drained().back(), "info: after drain");
+    EXPECT_EQ(metrics.counter("log.dropped").value(), extra);
+}
+
+TEST_F(AsyncLoggerTest, ConcurrentProducersLoseNothingButWhatIsCounted)
+{
+    const size_t threadCount = 4;
+    const size_t perThread = 500;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([this, t]()
+        {
+            for (size_t i = 0; i < perThread; i++)
+            {
+                asyncLogger.info(AsyncLogger::Category::General, "thread {} line {}", t, i);
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    auto lines = drained();
+    EXPECT_EQ(lines.size(), AsyncLogger::RING_CAPACITY);
+    EXPECT_EQ(lines.size() + metrics.counter("log.dropped").value(), threadCount * perThread);
+}
+
+TEST_F(AsyncLoggerTest, RepeatsWithinTheWindowAreFoldedThenReported)
+{
+    for (int i = 0; i < 5; i++)
+    {
+        asyncLogger.warning(AsyncLogger::Category::Gate, "Stand API timed out after {} ms", 3000);
+    }
+    asyncLogger.warning(AsyncLogger::Category::Gate, "Stand API timed out after {} ms", 5000);
+    EXPECT_EQ(drained(), std::vector<std::string>({
+        "warning: Stand API timed out after 3000 ms",
+        "warning: Stand API timed out after 5000 ms"}));
+    EXPECT_EQ(metrics.counter("log.suppressed").value(), 4u);
+
+    // Later drains in the window keep folding
+    asyncLogger.warning(AsyncLogger::Category::Gate, "Stand API timed out after {} ms", 3000);
+    EXPECT_EQ(drained().size(), 2u);
+    EXPECT_EQ(metrics.counter("log.suppressed").value(), 5u);
+
+    // Once the window is over the count is reported, then the message shows again
+    std::this_thread::sleep_for(AsyncLogger::DUPLICATE_WINDOW + std::chrono::milliseconds(100));
+    asyncLogger.warning(AsyncLogger::Category::Gate, "Stand API timed out after {} ms", 3000);
+    auto lines = drained();
+    ASSERT_EQ(lines.size(), 4u);
+    EXPECT_EQ(lines[2], "warning: Previous message repeated 5 times: Stand API timed out after 3000 ms");
+    EXPECT_EQ(lines[3], "warning: Stand API timed out after 3000 ms");
+}
@@ -0,0 +1,779 @@
+// Bench.cpp
+// Runs both modules polling against the stand-in server, then prints the cycle counts,
+// the heap allocations per cycle and the metrics summary (latency percentiles per job
+// and endpoint). The traffic is either one synthetic snapshot held for a while, or
+// recorded snapshots and API answers replayed at a multiple of real time. The latency
+// run times the gate tick against growing numbers of inbounds, each stand query held
+// by the stand-in for a fixed delay. The scaling run times a full oceanic pass for 1 to
+// one thread per core. The stands run allocates a bank of LFPG arrivals on the local
+// stand engine, without any network, and reconciles part of them with API answers. The
+// nattrak run compares CPU time and peak RSS of the SAX parse with a DOM parse on a large
+// payload, then shows the poller parsing it once and getting 304 afterwards. The fixes
+// run times the Brest entry fix lookup against the substring search it replaced, the icao
+// run the oceanic destination classifier against the regex it replaced. The metrics run
+// times each instrumentation call against a bare loop, alone and from several threads.
+//
+// usage: cofrance_bench [flights] [seconds]
+//        cofrance_bench replay <speed> <recording.jsonl>...
+//        cofrance_bench latency <delay_ms> [max_concurrent_requests]
+//        cofrance_bench scaling [flights]
+//        cofrance_bench stands [arrivals]
+//        cofrance_bench nattrak [clearances]
+//        cofrance_bench fixes [routes]
+//        cofrance_bench icao [codes]
+//        cofrance_bench metrics [threads]
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <random>
+#include <regex>
+#include <set>
+#include <string>
+#include <thread>
+#include <nlohmann/json.hpp>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <time.h>
+#endif
+#include "Harness.h"
+#include "Replay.h"
+#include "StandAllocator.h"
+#include "StandInServer.h"
+
+namespace
+{
+    std::atomic<uint64_t> allocations = 0;
+}
+
+// Heap allocations of the plugin threads, the stand-in server ones are left out
+void *operator new(std::size_t size)
+{
+    if (!StandInServer::StandInServer::isServerThread())
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void *pointer = std::malloc(size ? size : 1))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+namespace
+{
+    // Half arrivals at a stand API airport inside the query range, half Brest oceanic
+    // departures at various times from the exit, one in four of them cleared
+    void buildTraffic(Harness::Plugin &plugin, StandInServer::StandInServer &server, size_t flightCount)
+    {
+        std::vector<StandInServer::Clearance> clearances;
+        for (size_t i = 0; i < flightCount; i++)
+        {
+            PluginSDK::Flightplan::Flightplan flightplan;
+            flightplan.callsign = "BEN" + std::to_string(i);
+            flightplan.isValid = true;
+            flightplan.wakeCategory = "M";
+            flightplan.plannedAltitude = 36000;
+            PluginSDK::Aircraft::Aircraft aircraft;
+            aircraft.callsign = flightplan.callsign;
+            aircraft.position.groundSpeed = 450;
+            if (i % 2 == 0)
+            {
+                flightplan.origin = "EGLL";
+                flightplan.destination = "LFPG";
+                flightplan.route.rawRoute = "BIG DCT ABB";
+                server.setStand(flightplan.callsign, "S" + std::to_string(i % 200));
+                plugin.traffic.setAircraft(aircraft, 15.0);
+            }
+            else
+            {
+                flightplan.origin = "LFPG";
+                flightplan.destination = "KJFK";
+                flightplan.route.rawRoute = "EVX DCT LAPEX DCT 49N015W";
+                flightplan.route.waypoints = {{"EVX", {49.3, 1.0}}, {"LAPEX", {48.5, -8.0}}, {"49N015W", {49.0, -15.0}}};
+                aircraft.position.latitude = 49.3;
+                aircraft.position.longitude = 1.0 - static_cast<double>(i % 100) / 10.0;
+                plugin.traffic.setAircraft(aircraft, std::nullopt);
+                plugin.traffic.setControllerData({flightplan.callsign, 36000});
+                if (i % 4 == 1)
+                {
+                    clearances.push_back({flightplan.callsign, 360, "LAPEX", "12:00"});
+                }
+            }
+            plugin.traffic.setFlightplan(flightplan);
+        }
+        server.setAirports({"LFPG"}, true);
+        server.setClearances(std::move(clearances));
+    }
+}
+
+namespace
+{
+    // Counts gathered between two points of a run
+    struct Window
+    {
+        uint64_t gateCycles;
+        uint64_t oceanicCycles;
+        uint64_t allocations;
+        uint64_t getAllCalls; // Flight plans and aircraft, two per snapshot
+        std::chrono::steady_clock::time_point at;
+
+        static Window take(Harness::Plugin &plugin)
+        {
+            return {plugin.metrics.histogram("gate.cycle_us").count(), plugin.metrics.histogram("oceanic.cycle_us").count(),
+                ::allocations.load(), plugin.traffic.flightplanAPI.getAllCalls + plugin.traffic.aircraftAPI.getAllCalls,
+                std::chrono::steady_clock::now()};
+        }
+    };
+
+    void report(Harness::Plugin &plugin, StandInServer::StandInServer &server, size_t flightCount, const Window &start)
+    {
+        Window end = Window::take(plugin);
+        uint64_t allocationCount = end.allocations - start.allocations;
+        uint64_t cycleCount = end.gateCycles - start.gateCycles + end.oceanicCycles - start.oceanicCycles;
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end.at - start.at);
+
+        std::printf("flights: %zu, measured: %.1f s\n", flightCount, elapsed.count() / 1000.0);
+        std::printf("cycles: %llu gate, %llu oceanic\n",
+            static_cast<unsigned long long>(end.gateCycles - start.gateCycles), static_cast<unsigned long long>(end.oceanicCycles - start.oceanicCycles));
+        std::printf("allocations: %llu, %.1f per cycle, %.3f per flight and cycle\n", static_cast<unsigned long long>(allocationCount),
+            cycleCount ? static_cast<double>(allocationCount) / cycleCount : 0.0,
+            cycleCount && flightCount ? static_cast<double>(allocationCount) / cycleCount / flightCount : 0.0);
+        std::printf("sdk getAll: %llu, %.1f per minute\n", static_cast<unsigned long long>(end.getAllCalls - start.getAllCalls),
+            elapsed.count() ? (end.getAllCalls - start.getAllCalls) * 60000.0 / elapsed.count() : 0.0);
+        std::printf("stand-in: %zu airports, %zu queries, %zu batches, %zu nattrak, %zu connections\n",
+            server.requests(StandInServer::StandInServer::AIRPORTS), server.requests(StandInServer::StandInServer::QUERY),
+            server.requests(StandInServer::StandInServer::BATCH), server.requests(StandInServer::StandInServer::NATTRAK), server.connections());
+        std::printf("%s\n", plugin.metrics.summary().c_str());
+    }
+
+    // Both APIs on the stand-in, with budgets that never hold the pollers back
+    Config::Config benchConfig(const StandInServer::StandInServer &server)
+    {
+        Config::Config config;
+        config.gateAssignerApiBase = server.baseUrl();
+        config.nattrakApiBase = server.baseUrl();
+        config.gatePollingIntervalSec = 1;
+        config.standApiRequestsPerMinute = 6000;
+        config.standApiBurst = 100;
+        config.nattrakMinIntervalSec = 1;
+        config.nattrakMaxIntervalSec = 1;
+        config.nattrakRequestsPerMinute = 600;
+        return config;
+    }
+
+    int runSynthetic(size_t flightCount, int seconds)
+    {
+        StandInServer::StandInServer server;
+        Harness::Plugin plugin(benchConfig(server));
+        buildTraffic(plugin, server, flightCount);
+        plugin.gateAssigner().startPoller();
+        plugin.oceanicClearance().startPoller();
+
+        // Warm up until every arrival has its stand, caches and pools are then filled
+        auto &oceanicCycles = plugin.metrics.histogram("oceanic.cycle_us");
+        auto &gateTagUpdates = plugin.metrics.counter("gate.tag_updates");
+        if (!Harness::waitFor([&]() { return gateTagUpdates.value() >= (flightCount + 1) / 2 && oceanicCycles.count() >= 2; }, std::chrono::seconds(60)))
+        {
+            std::fprintf(stderr, "Warm-up did not complete: %llu stands, %llu oceanic cycles\n",
+                static_cast<unsigned long long>(gateTagUpdates.value()), static_cast<unsigned long long>(oceanicCycles.count()));
+            return 1;
+        }
+
+        Window start = Window::take(plugin);
+        std::this_thread::sleep_for(std::chrono::seconds(seconds));
+        report(plugin, server, flightCount, start);
+        return 0;
+    }
+
+    // Recorded time runs speed times faster than the clock, the polling intervals are shortened alike
+    int runReplay(double speed, const std::vector<std::filesystem::path> &files)
+    {
+        Replay::Recording recording = Replay::Recording::load(files);
+        StandInServer::StandInServer server;
+        Config::Config config = benchConfig(server);
+        config.gatePollingIntervalSec = std::max(1, static_cast<int>(GateAssigner::POLLING_INTERVAL_SEC / speed));
+        config.nattrakMinIntervalSec = std::max(1, static_cast<int>(OceanicClearance::MIN_POLLING_INTERVAL_SEC / speed));
+        config.nattrakMaxIntervalSec = std::max(1, static_cast<int>(OceanicClearance::MAX_POLLING_INTERVAL_SEC / speed));
+        Harness::Plugin plugin(config);
+
+        // The first frames are the traffic already there when the controller connects
+        std::set<std::string> callsigns;
+        auto changed = [&](const std::string &callsign)
+        {
+            callsigns.insert(callsign);
+            plugin.gateAssigner().markDirty(callsign);
+            plugin.oceanicClearance().markDirty(callsign);
+        };
+        recording.applyUntil(0, plugin.traffic, server, changed);
+        plugin.gateAssigner().startPoller();
+        plugin.oceanicClearance().startPoller();
+
+        Window start = Window::take(plugin);
+        while (!recording.finished())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start.at);
+            recording.applyUntil(elapsed.count() * speed, plugin.traffic, server, changed);
+        }
+        std::printf("replayed %.1f s of recording at %.1fx\n", recording.duration(), speed);
+        report(plugin, server, callsigns.size(), start);
+        return 0;
+    }
+}
+
+namespace
+{
+    // Wall time of the first gate tick, which queries every inbound one by one. The stand-in
+    // serves 8 connections at a time, concurrency above that only measures its queue.
+    int runLatency(std::chrono::milliseconds delay, size_t maxConcurrentRequests)
+    {
+        std::printf("stand query delay: %lld ms, max concurrent requests: %zu\n", static_cast<long long>(delay.count()), maxConcurrentRequests);
+        std::printf("%10s %12s %12s\n", "inbounds", "tick ms", "serial ms");
+        for (size_t inbounds : {1, 2, 4, 8, 16, 32, 64})
+        {
+            StandInServer::StandInServer server;
+            server.setAirports({"LFPG"}, false);
+            server.setDelay(StandInServer::StandInServer::QUERY, delay);
+            Config::Config config = benchConfig(server);
+            config.gateMaxConcurrentRequests = static_cast<int>(maxConcurrentRequests);
+            Harness::Plugin plugin(config);
+            for (size_t i = 0; i < inbounds; i++)
+            {
+                PluginSDK::Flightplan::Flightplan flightplan;
+                flightplan.callsign = "LAT" + std::to_string(i);
+                flightplan.origin = "EGLL";
+                flightplan.destination = "LFPG";
+                flightplan.wakeCategory = "M";
+                flightplan.isValid = true;
+                plugin.traffic.setFlightplan(flightplan);
+                PluginSDK::Aircraft::Aircraft aircraft;
+                aircraft.callsign = flightplan.callsign;
+                aircraft.position.groundSpeed = 180;
+                plugin.traffic.setAircraft(aircraft, 12.0);
+                server.setStand(flightplan.callsign, "S" + std::to_string(i));
+            }
+
+            auto &gateCycles = plugin.metrics.histogram("gate.cycle_us");
+            auto &gateTagUpdates = plugin.metrics.counter("gate.tag_updates");
+            plugin.gateAssigner().startPoller();
+            if (!Harness::waitFor([&]() { return gateTagUpdates.value() >= inbounds && gateCycles.count() >= 1; }, std::chrono::seconds(120)))
+            {
+                std::fprintf(stderr, "%zu inbounds: only %llu stands\n", inbounds, static_cast<unsigned long long>(gateTagUpdates.value()));
+                return 1;
+            }
+            std::printf("%10zu %12.1f %12lld\n", inbounds, gateCycles.max() / 1000.0, static_cast<long long>(delay.count() * inbounds));
+        }
+        return 0;
+    }
+}
+
+namespace
+{
+    // Median full pass of the oceanic poller, Nattrak answering at once, per evaluation thread count
+    int runScaling(size_t flightCount)
+    {
+        const uint64_t passes = 10;
+        size_t maxThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        std::printf("flights: %zu, %llu passes per row\n", flightCount, static_cast<unsigned long long>(passes));
+        std::printf("%10s %12s %12s %10s\n", "threads", "p50 us", "max us", "speedup");
+        uint64_t single = 0;
+        for (size_t threads = 1; threads <= maxThreads; threads++)
+        {
+            StandInServer::StandInServer server;
+            Config::Config config = benchConfig(server);
+            config.oceanicEvaluationThreads = static_cast<int>(threads);
+            Harness::Plugin plugin(config);
+            buildTraffic(plugin, server, flightCount);
+
+            auto &evaluations = plugin.metrics.histogram("oceanic.evaluation_us");
+            plugin.oceanicClearance().startPoller();
+            if (!Harness::waitFor([&]() { return evaluations.count() >= passes; }, std::chrono::seconds(passes * 5)))
+            {
+                std::fprintf(stderr, "%zu threads: only %llu passes\n", threads, static_cast<unsigned long long>(evaluations.count()));
+                return 1;
+            }
+            uint64_t median = evaluations.percentile(50);
+            single = threads == 1 ? median : single;
+            std::printf("%10zu %12llu %12llu %9.2fx\n", threads, static_cast<unsigned long long>(median),
+                static_cast<unsigned long long>(evaluations.max()), median ? static_cast<double>(single) / median : 0.0);
+        }
+        return 0;
+    }
+}
+
+namespace
+{
+    // Nanoseconds at the given percentile of sorted samples
+    long long percentileOf(const std::vector<long long> &sorted, double percent)
+    {
+        return sorted.empty() ? 0 : sorted[std::min(sorted.size() - 1, static_cast<size_t>(sorted.size() * percent / 100))];
+    }
+
+    // A bank of arrivals two minutes apart at LFPG, on 2E heavy stands preferred by Air France,
+    // 2F stands preferred by Schengen origins and remote stands open to all. One arrival in four
+    // then gets an API stand, which bumps the provisional ones it overlaps.
+    int runStands(size_t arrivals)
+    {
+        std::filesystem::path path = std::filesystem::temp_directory_path() / ("cofrance-bench-stands-" + std::to_string(std::random_device()()) + ".toml");
+        {
+            std::ofstream data(path);
+            for (int i = 1; i <= 40; i++)
+            {
+                data << "[[stands]]\nairport = \"LFPG\"\nname = \"E" << i << "\"\nwake = [\"H\", \"M\"]\nairlines = [\"AFR\"]\n\n";
+                data << "[[stands]]\nairport = \"LFPG\"\nname = \"F" << i << "\"\nwake = [\"M\", \"L\"]\norigins = [\"LF\", \"ED\", \"LE\", \"LI\"]\n\n";
+                data << "[[stands]]\nairport = \"LFPG\"\nname = \"R" << i << "\"\n\n";
+            }
+        }
+        FakeSdk::Logger logger;
+        Metrics::Registry metrics;
+        AsyncLogger::AsyncLogger asyncLogger{logger, metrics};
+        StandAllocator::StandAllocator allocator(asyncLogger);
+        bool loaded = allocator.load(path);
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        if (!loaded)
+        {
+            std::fprintf(stderr, "Cannot load the stand data\n");
+            return 1;
+        }
+
+        const std::vector<std::string> airlines = {"AFR", "AFR", "BAW", "DLH", "EZY", "UAE"};
+        const std::vector<std::string> origins = {"LFML", "EDDF", "EGLL", "LEMD", "KJFK", "OMDB", "LIRF"};
+        std::mt19937 random(42);
+        auto start = std::chrono::steady_clock::now();
+        struct Arrival
+        {
+            std::string callsign;
+            std::string origin;
+            std::string wakeCategory;
+            StandAllocator::TimePoint onBlock;
+        };
+        std::vector<Arrival> bank;
+        for (size_t i = 0; i < arrivals; i++)
+        {
+            bank.push_back({airlines[random() % airlines.size()] + std::to_string(100 + i), origins[random() % origins.size()],
+                random() % 5 == 0 ? "H" : "M", start + std::chrono::minutes(2) * static_cast<int>(i)});
+        }
+
+        std::vector<long long> durations;
+        auto allocate = [&](const Arrival &arrival)
+        {
+            auto before = std::chrono::steady_clock::now();
+            auto stand = allocator.allocate(arrival.callsign, "LFPG", arrival.origin, arrival.wakeCategory, arrival.onBlock);
+            durations.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - before).count());
+            return stand;
+        };
+        size_t allocated = 0;
+        for (const auto &arrival : bank)
+        {
+            allocated += allocate(arrival) ? 1 : 0;
+        }
+        auto bankDuration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+        // The API puts one arrival in four on a remote stand of its own choice
+        size_t bumps = 0;
+        size_t reallocated = 0;
+        std::vector<long long> confirmDurations;
+        for (size_t i = 0; i < bank.size(); i += 4)
+        {
+            auto before = std::chrono::steady_clock::now();
+            auto bumped = allocator.confirm(bank[i].callsign, "LFPG", "R" + std::to_string(1 + random() % 40), bank[i].onBlock);
+            confirmDurations.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - before).count());
+            bumps += bumped.size();
+            for (const auto &callsign : bumped)
+            {
+                auto arrival = std::find_if(bank.begin(), bank.end(), [&callsign](const Arrival &candidate) { return candidate.callsign == callsign; });
+                reallocated += allocate(*arrival) ? 1 : 0;
+            }
+        }
+
+        std::sort(durations.begin(), durations.end());
+        std::sort(confirmDurations.begin(), confirmDurations.end());
+        std::printf("stands: 120, arrivals: %zu, allocated: %zu, whole bank: %lld us\n", arrivals, allocated, static_cast<long long>(bankDuration.count()));
+        std::printf("allocate ns: p50 %lld, p99 %lld, max %lld\n", percentileOf(durations, 50), percentileOf(durations, 99), durations.empty() ? 0 : durations.back());
+        std::printf("confirm ns: p50 %lld, p99 %lld, max %lld\n", percentileOf(confirmDurations, 50), percentileOf(confirmDurations, 99),
+            confirmDurations.empty() ? 0 : confirmDurations.back());
+        std::printf("api confirmations: %zu, provisional stands bumped: %zu, given another stand: %zu\n", confirmDurations.size(), bumps, reallocated);
+        return 0;
+    }
+}
+
+namespace
+{
+    // Peak resident set of the process so far, in KiB
+    long long peakRssKb(void)
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? static_cast<long long>(counters.PeakWorkingSetSize / 1024) : 0;
+#else
+        rusage usage;
+        return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+#endif
+    }
+
+    // CPU time of the calling thread, other threads of the process left out
+    std::chrono::microseconds threadCpuTime(void)
+    {
+#ifdef _WIN32
+        FILETIME creation, exit, kernel, user;
+        GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+        auto ticks = (static_cast<uint64_t>(kernel.dwHighDateTime) << 32 | kernel.dwLowDateTime) + (static_cast<uint64_t>(user.dwHighDateTime) << 32 | user.dwLowDateTime);
+        return std::chrono::microseconds(ticks / 10);
+#else
+        timespec time;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+        return std::chrono::microseconds(static_cast<long long>(time.tv_sec) * 1000000 + time.tv_nsec / 1000);
+#endif
+    }
+
+    // Nattrak answer of the given size parsed through the SAX handler, then into a DOM as the
+    // plugin did before. Peak RSS only grows, so the SAX parse runs first and each growth is
+    // measured from the peak before it. The poller then fetches the same payload from the
+    // stand-in: parsed once, the unchanged answers are 304.
+    int runNattrak(size_t clearanceCount)
+    {
+        // Written straight to text, a DOM built here would leave freed memory for the parses to reuse
+        std::string body = "[";
+        for (size_t i = 0; i < clearanceCount; i++)
+        {
+            body += std::string(i ? "," : "") + "{\"callsign\":\"BAW" + std::to_string(i) + "\",\"status\":\"" + (i % 4 ? "CLEARED" : "NOTICE")
+                + "\",\"level\":\"" + std::to_string(300 + i % 10 * 10) + "\",\"fix\":\"LAPEX\",\"estimating_time\":\"12:" + std::to_string(10 + i % 50)
+                + "\",\"route\":\"LAPEX 49N015W 50N020W 51N030W 51N040W 50N050W\",\"extra\":{\"tmi\":\"123\",\"revision\":" + std::to_string(i % 7) + "}}";
+        }
+        body += "]";
+
+        long long rssBefore = peakRssKb();
+        auto cpuBefore = threadCpuTime();
+        auto clearances = OceanicClearance::OceanicClearance::parseNattrakData(body);
+        auto saxCpu = threadCpuTime() - cpuBefore;
+        long long saxRss = peakRssKb() - rssBefore;
+        if (!clearances || clearances->size() != clearanceCount)
+        {
+            std::fprintf(stderr, "SAX parse returned %zu clearances\n", clearances ? clearances->size() : 0);
+            return 1;
+        }
+
+        rssBefore = peakRssKb();
+        cpuBefore = threadCpuTime();
+        nlohmann::json dom = nlohmann::json::parse(body);
+        auto domCpu = threadCpuTime() - cpuBefore;
+        long long domRss = peakRssKb() - rssBefore;
+        dom = nlohmann::json();
+
+        std::printf("payload: %zu clearances, %.1f MB\n", clearanceCount, body.size() / 1e6);
+        std::printf("%10s %12s %16s\n", "parse", "cpu ms", "peak rss +KiB");
+        std::printf("%10s %12.1f %16lld\n", "sax", saxCpu.count() / 1000.0, saxRss);
+        std::printf("%10s %12.1f %16lld\n", "dom", domCpu.count() / 1000.0, domRss);
+
+        StandInServer::StandInServer server;
+        server.setNattrakBody(body);
+        Harness::Plugin plugin(benchConfig(server));
+        auto &parses = plugin.metrics.histogram("oceanic.nattrak_parse_us");
+        plugin.oceanicClearance().startPoller();
+        if (!Harness::waitFor([&]() { return server.notModified(StandInServer::StandInServer::NATTRAK) >= 5; }, std::chrono::seconds(30)))
+        {
+            std::fprintf(stderr, "Only %zu answers 304\n", server.notModified(StandInServer::StandInServer::NATTRAK));
+            return 1;
+        }
+        std::printf("poller: %zu fetches, %zu not modified, %llu parses, parse %.1f ms\n",
+            server.requests(StandInServer::StandInServer::NATTRAK), server.notModified(StandInServer::StandInServer::NATTRAK),
+            static_cast<unsigned long long>(parses.count()), parses.max() / 1000.0);
+        return 0;
+    }
+}
+
+namespace
+{
+    // Entry fix check replaced by BREST_OCEANIC_POINTS: any fix name anywhere in the upper-cased route
+    bool stringContainsValue(const std::string &str, const std::vector<std::string> &values)
+    {
+        std::string strUpper = str;
+        std::transform(strUpper.begin(), strUpper.end(), strUpper.begin(), ::toupper);
+        for (const auto &value : values)
+        {
+            if (strUpper.find(value) != std::string::npos)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Nanoseconds per call of check over every input, repeated until it ran for a while
+    template <typename Check>
+    double nanosecondsPerCall(const std::vector<std::string> &inputs, size_t &matches, Check check)
+    {
+        size_t calls = 0;
+        matches = 0;
+        auto start = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::steady_clock::duration(0);
+        while (elapsed < std::chrono::milliseconds(200))
+        {
+            for (const auto &input : inputs)
+            {
+                matches += check(input) ? 1 : 0;
+            }
+            calls += inputs.size();
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+        matches = matches * inputs.size() / calls;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / calls;
+    }
+
+    // Routes of 8 to 30 tokens with airways, speed and level groups and five-letter points.
+    // One in four goes through a Brest entry fix, with a speed and level suffix half of the
+    // time; one in eight has a point merely containing a fix name.
+    int runFixes(size_t routeCount)
+    {
+        const std::vector<std::string> brestFixes = {"REGHI", "UMLER", "LAPEX", "BUNAV", "RIVAK", "ETIKI", "SEPAL", "SIVIR", "LARLA"};
+        const std::vector<std::string> airways = {"DCT", "UN490", "UL613", "UM605", "UT300", "UN866", "Y8", "UZ107"};
+        std::mt19937 random(7);
+        auto point = [&random]()
+        {
+            std::string name(5, 'A');
+            for (auto &c : name)
+            {
+                c = static_cast<char>('A' + random() % 26);
+            }
+            return name;
+        };
+
+        std::vector<std::string> routes;
+        for (size_t i = 0; i < routeCount; i++)
+        {
+            size_t tokens = 8 + random() % 23;
+            std::string route = "N0" + std::to_string(440 + random() % 50) + "F" + std::to_string(300 + random() % 10 * 10);
+            for (size_t t = 0; t < tokens; t++)
+            {
+                route += " " + (t % 2 ? airways[random() % airways.size()] : point());
+            }
+            if (i % 4 == 0)
+            {
+                route += " " + brestFixes[random() % brestFixes.size()] + (random() % 2 ? "/N0480F370" : "") + " DCT 48N015W";
+            }
+            else if (i % 8 == 1)
+            {
+                route += " X" + brestFixes[random() % brestFixes.size()];
+            }
+            routes.push_back(std::move(route));
+        }
+
+        size_t substringMatches = 0;
+        size_t tokenMatches = 0;
+        double substring = nanosecondsPerCall(routes, substringMatches,
+            [&brestFixes](const std::string &route) { return stringContainsValue(route, brestFixes); });
+        double token = nanosecondsPerCall(routes, tokenMatches,
+            [](const std::string &route) { return OceanicClearance::BREST_OCEANIC_POINTS.findFirst(route).has_value(); });
+
+        std::printf("routes: %zu, %zu through a Brest fix, %zu more substring matches\n", routes.size(), tokenMatches, substringMatches - tokenMatches);
+        std::printf("%22s %12s\n", "lookup", "ns/route");
+        std::printf("%22s %12.1f\n", "stringContainsValue", substring);
+        std::printf("%22s %12.1f\n", "FixSet::findFirst", token);
+        std::printf("speedup: %.1fx\n", token > 0 ? substring / token : 0.0);
+        return 0;
+    }
+}
+
+namespace
+{
+    // Destination check replaced by OCEANIC_DESTINATIONS
+    const std::regex OCEANIC_DESTINATION_REGEX("([KCPTSMN][A-Z]{3}|LFVP|LFVM)");
+
+    // Destinations drawn like a day of Brest and Paris traffic: mostly European codes, a
+    // third North American and Caribbean, a few French overseas ones and malformed entries
+    int runIcao(size_t codeCount)
+    {
+        const std::vector<std::string> frequent = {"LFPG", "LFPO", "EGLL", "EDDF", "LEMD", "LFVP", "LFVM", "LFMN", "KJFK", "CYUL", "TFFR", "MMUN", "SBGR", "", "lfpg", "ZZZZ1"};
+        std::mt19937 random(11);
+        std::vector<std::string> codes;
+        for (size_t i = 0; i < codeCount; i++)
+        {
+            if (random() % 2)
+            {
+                codes.push_back(frequent[random() % frequent.size()]);
+                continue;
+            }
+            std::string code(4, 'A');
+            code[0] = "LLLLEEEKKCCMTSPN"[random() % 16];
+            for (size_t c = 1; c < 4; c++)
+            {
+                code[c] = static_cast<char>('A' + random() % 26);
+            }
+            codes.push_back(std::move(code));
+        }
+
+        size_t disagreements = 0;
+        for (const auto &code : codes)
+        {
+            disagreements += std::regex_match(code, OCEANIC_DESTINATION_REGEX) != OceanicClearance::OCEANIC_DESTINATIONS.matches(code) ? 1 : 0;
+        }
+
+        size_t regexMatches = 0;
+        size_t classifierMatches = 0;
+        double regex = nanosecondsPerCall(codes, regexMatches,
+            [](const std::string &code) { return std::regex_match(code, OCEANIC_DESTINATION_REGEX); });
+        double classifier = nanosecondsPerCall(codes, classifierMatches,
+            [](const std::string &code) { return OceanicClearance::OCEANIC_DESTINATIONS.matches(code); });
+
+        std::printf("codes: %zu, %zu oceanic, %zu disagreements\n", codes.size(), classifierMatches, disagreements);
+        std::printf("%22s %12s\n", "check", "ns/code");
+        std::printf("%22s %12.1f\n", "std::regex_match", regex);
+        std::printf("%22s %12.1f\n", "IcaoClassifier", classifier);
+        std::printf("speedup: %.1fx\n", classifier > 0 ? regex / classifier : 0.0);
+        return disagreements == 0 ? 0 : 1;
+    }
+}
+
+namespace
+{
+    // Nanoseconds per call of operation over every value, repeated until it ran for a while
+    template <typename Operation>
+    double nanosecondsPerOperation(const std::vector<uint64_t> &values, Operation operation)
+    {
+        size_t calls = 0;
+        auto start = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::steady_clock::duration(0);
+        while (elapsed < std::chrono::milliseconds(200))
+        {
+            for (uint64_t value : values)
+            {
+                operation(value);
+            }
+            calls += values.size();
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+        return std::chrono::duration<double, std::nano>(elapsed).count() / calls;
+    }
+
+    // Cost of every instrumentation call the pollers make, on latencies spread like the
+    // endpoint ones (a few hundred microseconds to a few seconds). The bare loop only sums
+    // them, the difference is what the metrics add. The contended run has every thread
+    // record into the same histogram, as the gate and oceanic workers share the endpoint ones.
+    int runMetrics(size_t threadCount)
+    {
+        std::mt19937 random(13);
+        std::lognormal_distribution<double> latency(10.0, 1.5);
+        std::vector<uint64_t> values(4096);
+        for (auto &value : values)
+        {
+            value = static_cast<uint64_t>(latency(random));
+        }
+
+        Metrics::Registry registry;
+        Metrics::Counter &counter = registry.counter("bench.counter");
+        Metrics::Gauge &gauge = registry.gauge("bench.gauge");
+        Metrics::Histogram &histogram = registry.histogram("bench.latency_us");
+        Metrics::EndpointMetrics endpoint(registry, "bench.endpoint");
+        volatile uint64_t sink = 0;
+
+        std::printf("%26s %12s\n", "call", "ns/call");
+        std::printf("%26s %12.1f\n", "bare loop", nanosecondsPerOperation(values, [&sink](uint64_t value) { sink = sink + value; }));
+        std::printf("%26s %12.1f\n", "Counter::add", nanosecondsPerOperation(values, [&counter](uint64_t) { counter.add(); }));
+        std::printf("%26s %12.1f\n", "Gauge::set", nanosecondsPerOperation(values, [&gauge](uint64_t value) { gauge.set(static_cast<int64_t>(value)); }));
+        std::printf("%26s %12.1f\n", "Histogram::record", nanosecondsPerOperation(values, [&histogram](uint64_t value) { histogram.record(value); }));
+        std::printf("%26s %12.1f\n", "EndpointMetrics::record", nanosecondsPerOperation(values, [&endpoint](uint64_t value)
+        {
+            endpoint.record(value % 16 ? 200 : 503, std::chrono::microseconds(value));
+        }));
+        std::printf("%26s %12.1f\n", "ScopedTimer", nanosecondsPerOperation(values, [&histogram](uint64_t) { Metrics::ScopedTimer timer(histogram); }));
+        std::printf("%26s %12.1f\n", "Registry::counter lookup", nanosecondsPerOperation(values, [&registry](uint64_t) { registry.counter("bench.counter").add(); }));
+
+        Metrics::Histogram &shared = registry.histogram("bench.shared_latency_us");
+        std::vector<double> perThread(threadCount);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < threadCount; t++)
+        {
+            threads.emplace_back([&values, &shared, &perThread, t]()
+            {
+                perThread[t] = nanosecondsPerOperation(values, [&shared](uint64_t value) { shared.record(value); });
+            });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+        // Calls of all threads per unit of wall time, on one core this is the uncontended cost
+        double callsPerNanosecond = 0;
+        for (double ns : perThread)
+        {
+            callsPerNanosecond += ns > 0 ? 1 / ns : 0;
+        }
+        std::printf("%zu threads on %u cores, Histogram::record: %.1f ns/call across threads\n", threadCount,
+            std::thread::hardware_concurrency(), callsPerNanosecond > 0 ? 1 / callsPerNanosecond : 0.0);
+        return 0;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && std::strcmp(argv[1], "metrics") == 0)
+    {
+        return runMetrics(argc > 2 ? std::stoul(argv[2]) : 4);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "icao") == 0)
+    {
+        return runIcao(argc > 2 ? std::stoul(argv[2]) : 10000);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "fixes") == 0)
+    {
+        return runFixes(argc > 2 ? std::stoul(argv[2]) : 10000);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "nattrak") == 0)
+    {
+        return runNattrak(argc > 2 ? std::stoul(argv[2]) : 20000);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "stands") == 0)
+    {
+        return runStands(argc > 2 ? std::stoul(argv[2]) : 200);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "scaling") == 0)
+    {
+        return runScaling(argc > 2 ? std::stoul(argv[2]) : 5000);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "latency") == 0)
+    {
+        if (argc < 3)
+        {
+            std::fprintf(stderr, "usage: %s latency <delay_ms> [max_concurrent_requests]\n", argv[0]);
+            return 2;
+        }
+        return runLatency(std::chrono::milliseconds(std::stoi(argv[2])), argc > 3 ? std::stoul(argv[3]) : GateAssigner::MAX_CONCURRENT_REQUESTS);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "replay") == 0)
+    {
+        if (argc < 4)
+        {
+            std::fprintf(stderr, "usage: %s replay <speed> <recording.jsonl>...\n", argv[0]);
+            return 2;
+        }
+        try
+        {
+            return runReplay(std::stod(argv[2]), std::vector<std::filesystem::path>(argv + 3, argv + argc));
+        }
+        catch (const std::exception &e)
+        {
+            std::fprintf(stderr, "Replay failed: %s\n", e.what());
+            return 1;
+        }
+    }
+    return runSynthetic(argc > 1 ? std::stoul(argv[1]) : 2000, argc > 2 ? std::stoi(argv[2]) : 20);
+}
@@ -0,0 +1,182 @@
+// CircuitBreakerTest.cpp
+#include <thread>
+#include <gtest/gtest.h>
+#include "CircuitBreaker.h"
+#include "FakeSdk.h"
+#include "Harness.h"
+#include "RateLimiter.h"
+#include "StandInServer.h"
+
+namespace
+{
+    const std::chrono::milliseconds TEST_BACKOFF = std::chrono::milliseconds(20); // Up to 25 ms with jitter
+
+    class CircuitBreakerTest : public testing::Test
+    {
+        protected:
+            FakeSdk::Logger sink_;
+            Metrics::Registry metrics_;
+            AsyncLogger::AsyncLogger logger_{sink_, metrics_};
+            CircuitBreaker::CircuitBreaker breaker_{"Test API", logger_, metrics_, TEST_BACKOFF};
+
+            void open(void)
+            {
+                for (int i = 0; i < CircuitBreaker::FAILURE_THRESHOLD; i++)
+                {
+                    ASSERT_TRUE(breaker_.allowRequest());
+                    breaker_.recordFailure();
+                }
+                ASSERT_EQ(breaker_.state(), CircuitBreaker::State::Open);
+            }
+    };
+}
+
+TEST_F(CircuitBreakerTest, OpensAfterConsecutiveFailures)
+{
+    for (int i = 0; i < CircuitBreaker::FAILURE_THRESHOLD - 1; i++)
+    {
+        breaker_.recordFailure();
+    }
+    EXPECT_EQ(breaker_.state(), CircuitBreaker::State::Closed);
+
+    // A success in between starts the count again
+    breaker_.recordSuccess();
+    for (int i = 0; i < CircuitBreaker::FAILURE_THRESHOLD - 1; i++)
+    {
+        breaker_.recordFailure();
+    }
+    EXPECT_EQ(breaker_.state(), CircuitBreaker::State::Closed);
+
+    breaker_.recordFailure();
+    EXPECT_EQ(breaker_.state(), CircuitBreaker::State::Open);
+    EXPECT_FALSE(breaker_.allowRequest());
+    EXPECT_EQ(metrics_.counter("Test API.breaker.rejected").value(), 1u);
+    EXPECT_EQ(metrics_.gauge("Test API.breaker.state").value(), static_cast<int64_t>(CircuitBreaker::State::Open));
+}
+
+TEST_F(CircuitBreakerTest, LetsASingleProbeThroughAfterTheBackoff)
+{
+    open();
+    std::this_thread::sleep_for(TEST_BACKOFF * 2);
+
+    EXPECT_TRUE(breaker_.allowRequest());
+    EXPECT_EQ(breaker_.state(), CircuitBreaker::State::HalfOpen);
+    EXPECT_FALSE(breaker_.allowRequest());
+
+    breaker_.recordSuccess();
+    EXPECT_EQ(breaker_.state(), CircuitBreaker::State::Closed);
+    EXPECT_TRUE(breaker_.allowRequest());
+}
+
+TEST_F(CircuitBreakerTest, FailedProbeReopensWithALongerBackoff)
+{
+    open();
+    std::this_thread::sleep_for(TEST_BACKOFF * 2);
+    ASSERT_TRUE(breaker_.allowRequest());
+    breaker_.recordFailure();
+    EXPECT_EQ(breaker_.state(), CircuitBreaker::State::Open);
+
+    // Second backoff is 40 to 50 ms
+    std::this_thread::sleep_for(TEST_BACKOFF * 3 / 2);
+    EXPECT_FALSE(breaker_.allowRequest());
+    std::this_thread::sleep_for(TEST_BACKOFF * 2);
+    EXPECT_TRUE(breaker_.allowRequest());
+}
+
+TEST_F(CircuitBreakerTest, ProbeRefusedByTheRateLimiterIsAbandoned)
+{
+    RateLimiter::TokenBucket limiter("Test API", 60, 10, logger_, metrics_);
+    limiter.recordResponse(429, "");
+    open();
+    std::this_thread::sleep_for(TEST_BACKOFF * 2);
+
+    // The call sites check the breaker, then the bucket
+    ASSERT_TRUE(breaker_.allowRequest());
+    ASSERT_FALSE(limiter.tryAcquire());
+    breaker_.abandonProbe();
+    EXPECT_EQ(breaker_.state(), CircuitBreaker::State::Open);
+
+    // Not stuck half-open: the next call probes again and its outcome closes the breaker
+    ASSERT_TRUE(breaker_.allowRequest());
+    EXPECT_EQ(breaker_.state(), CircuitBreaker::State::HalfOpen);
+    breaker_.recordSuccess();
+    EXPECT_EQ(breaker_.state(), CircuitBreaker::State::Closed);
+}
+
+TEST_F(CircuitBreakerTest, AbandonProbeLeavesAClosedBreakerAlone)
+{
+    ASSERT_TRUE(breaker_.allowRequest());
+    breaker_.abandonProbe();
+    EXPECT_EQ(breaker_.state(), CircuitBreaker::State::Closed);
+}
+
+TEST(CircuitBreakerStatusTest, FailureStatuses)
+{
+    EXPECT_TRUE(CircuitBreaker::CircuitBreaker::isFailureStatus(0));
+    EXPECT_TRUE(CircuitBreaker::CircuitBreaker::isFailureStatus(408));
+    EXPECT_TRUE(CircuitBreaker::CircuitBreaker::isFailureStatus(429));
+    EXPECT_TRUE(CircuitBreaker::CircuitBreaker::isFailureStatus(500));
+    EXPECT_TRUE(CircuitBreaker::CircuitBreaker::isFailureStatus(503));
+    EXPECT_FALSE(CircuitBreaker::CircuitBreaker::isFailureStatus(200));
+    EXPECT_FALSE(CircuitBreaker::CircuitBreaker::isFailureStatus(304));
+    EXPECT_FALSE(CircuitBreaker::CircuitBreaker::isFailureStatus(404));
+}
+
+// Fault injection through the stand-in: the stand API stops being called once the breaker is open
+
+TEST(CircuitBreakerFaultTest, FailingStandApiIsCalledThreeTimes)
+{
+    StandInServer::StandInServer server;
+    server.setStatus(StandInServer::StandInServer::AIRPORTS, 503);
+    Config::Config config;
+    config.gateAssignerApiBase = server.baseUrl();
+    config.gatePollingIntervalSec = 1;
+    Harness::Plugin plugin(config);
+
+    plugin.gateAssigner().startPoller();
+    auto &state = plugin.metrics.gauge("GateAssigner API.breaker.state");
+    ASSERT_TRUE(Harness::waitFor([&]() { return state.value() == static_cast<int64_t>(CircuitBreaker::State::Open); }, std::chrono::seconds(15)));
+
+    // Polls keep running during the 15 s backoff without reaching the server
+    auto &rejected = plugin.metrics.counter("GateAssigner API.breaker.rejected");
+    ASSERT_TRUE(Harness::waitFor([&]() { return rejected.value() >= 2; }, std::chrono::seconds(10)));
+    EXPECT_EQ(server.requests(StandInServer::StandInServer::AIRPORTS), static_cast<size_t>(CircuitBreaker::FAILURE_THRESHOLD));
+    EXPECT_EQ(plugin.metrics.counter("http.stand_airports.status.5xx").value(), static_cast<uint64_t>(CircuitBreaker::FAILURE_THRESHOLD));
+}
+
+TEST(CircuitBreakerFaultTest, RefusedConnectionsOpenTheBreaker)
+{
+    std::string closedBaseUrl;
+    {
+        StandInServer::StandInServer server;
+        closedBaseUrl = server.baseUrl();
+    }
+    Config::Config config;
+    config.gateAssignerApiBase = closedBaseUrl;
+    config.gatePollingIntervalSec = 1;
+    Harness::Plugin plugin(config);
+
+    plugin.gateAssigner().startPoller();
+    auto &state = plugin.metrics.gauge("GateAssigner API.breaker.state");
+    ASSERT_TRUE(Harness::waitFor([&]() { return state.value() == static_cast<int64_t>(CircuitBreaker::State::Open); }, std::chrono::seconds(15)));
+    EXPECT_EQ(plugin.metrics.counter("http.stand_airports.failures").value(), static_cast<uint64_t>(CircuitBreaker::FAILURE_THRESHOLD));
+}
+
+TEST(CircuitBreakerFaultTest, FailingNattrakIsCalledThreeTimes)
+{
+    StandInServer::StandInServer server;
+    server.setStatus(StandInServer::StandInServer::NATTRAK, 500);
+    Config::Config config;
+    config.nattrakApiBase = server.baseUrl();
+    config.nattrakMinIntervalSec = 1;
+    config.nattrakMaxIntervalSec = 1;
+    config.nattrakRequestsPerMinute = 600;
+    Harness::Plugin plugin(config);
+
+    plugin.oceanicClearance().startPoller();
+    auto &state = plugin.metrics.gauge("Nattrak API.breaker.state");
+    ASSERT_TRUE(Harness::waitFor([&]() { return state.value() == static_cast<int64_t>(CircuitBreaker::State::Open); }, std::chrono::seconds(20)));
+    auto &rejected = plugin.metrics.counter("Nattrak API.breaker.rejected");
+    ASSERT_TRUE(Harness::waitFor([&]() { return rejected.value() >= 2; }, std::chrono::seconds(15)));
+    EXPECT_EQ(server.requests(StandInServer::StandInServer::NATTRAK), static_cast<size_t>(CircuitBreaker::FAILURE_THRESHOLD));
+}
@@ -0,0 +1,157 @@
+// DiskCacheTest.cpp
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "AsyncLogger.h"
+#include "DiskCache.h"
+#include "FakeSdk.h"
+#include "Metrics.h"
+
+namespace
+{
+    const std::vector<DiskCache::Record> RECORDS = {
+        {"AFR1", "LFPG", "E22"},
+        {},
+        {"", std::string("\0\xff\n", 3), std::string(4096, 'x')}};
+
+    // Cache directory of a test, sections are written by hand to check the header
+    class DiskCacheTest : public ::testing::Test
+    {
+        protected:
+            void SetUp(void) override
+            {
+                std::filesystem::create_directories(directory);
+            }
+
+            void TearDown(void) override
+            {
+                std::error_code error;
+                std::filesystem::remove_all(directory, error);
+            }
+
+            // Section file in the layout save() writes: magic, version, save time, records
+            void write(const std::string &section, std::string_view magic, uint32_t version, std::chrono::system_clock::time_point savedAt, const std::string &payload)
+            {
+                int64_t seconds = std::chrono::duration_cast<std::chrono::seconds>(savedAt.time_since_epoch()).count();
+                std::ofstream file(directory / (section + ".cache"), std::ios::binary | std::ios::trunc);
+                file.write(magic.data(), magic.size());
+                file.write(reinterpret_cast<const char *>(&version), sizeof(version));
+                file.write(reinterpret_cast<const char *>(&seconds), sizeof(seconds));
+                file.write(payload.data(), payload.size());
+            }
+
+            size_t warnings(void)
+            {
+                asyncLogger.drain();
+                size_t count = 0;
+                for (const auto &line : logger.lines())
+                {
+                    count += line.starts_with("warning: Ignoring unreadable cache") ? 1 : 0;
+                }
+                return count;
+            }
+
+            std::filesystem::path directory = std::filesystem::temp_directory_path() / ("cofrance-disk-" + std::to_string(std::random_device()()));
+            FakeSdk::Logger logger;
+            Metrics::Registry metrics;
+            AsyncLogger::AsyncLogger asyncLogger{logger, metrics};
+            DiskCache::DiskCache cache{directory, asyncLogger};
+    };
+}
+
+TEST(DiskCacheRecordsTest, RecordsRoundTrip)
+{
+    EXPECT_EQ(DiskCache::decodeRecords(DiskCache::encodeRecords(RECORDS)), RECORDS);
+    EXPECT_EQ(DiskCache::decodeRecords(DiskCache::encodeRecords({})), std::vector<DiskCache::Record>());
+}
+
+TEST(DiskCacheRecordsTest, TruncatedRecordsAreRejected)
+{
+    std::string encoded = DiskCache::encodeRecords(RECORDS);
+    for (size_t length = 0; length < encoded.size(); length++)
+    {
+        EXPECT_EQ(DiskCache::decodeRecords(std::string_view(encoded).substr(0, length)), std::nullopt) << length;
+    }
+}
+
+TEST(DiskCacheRecordsTest, CorruptRecordsAreRejected)
+{
+    std::string encoded = DiskCache::encodeRecords({{"AFR1", "E22"}});
+    EXPECT_EQ(DiskCache::decodeRecords(encoded + "x"), std::nullopt); // Trailing bytes
+    EXPECT_EQ(DiskCache::decodeRecords(encoded + encoded), std::nullopt);
+    EXPECT_EQ(DiskCache::decodeRecords(DiskCache::encodeRecords({{std::string(4097, 'x')}})), std::nullopt); // Field over 4 KiB
+
+    // Record count one too low leaves a record behind, one too high runs out of data
+    std::string fewer = DiskCache::encodeRecords({{"AFR1"}, {"AFR2"}});
+    fewer[0] = 1;
+    EXPECT_EQ(DiskCache::decodeRecords(fewer), std::nullopt);
+    std::string more = encoded;
+    more[0] = 2;
+    EXPECT_EQ(DiskCache::decodeRecords(more), std::nullopt);
+
+    // Field length past the end of the buffer
+    std::string longer = encoded;
+    longer[6] = 100;
+    EXPECT_EQ(DiskCache::decodeRecords(longer), std::nullopt);
+}
+
+TEST_F(DiskCacheTest, SavedSectionsLoadBack)
+{
+    cache.save("stands", RECORDS);
+    cache.save("clearances", {{"BAW1"}});
+    EXPECT_EQ(cache.load("stands", std::chrono::minutes(1)), RECORDS);
+    EXPECT_EQ(cache.load("clearances", std::chrono::minutes(1)), std::vector<DiskCache::Record>({{"BAW1"}}));
+
+    cache.save("stands", {});
+    EXPECT_EQ(cache.load("stands", std::chrono::minutes(1)), std::vector<DiskCache::Record>());
+    EXPECT_FALSE(std::filesystem::exists(directory / "stands.cache.tmp"));
+
+    // A missing section is not worth a warning
+    EXPECT_EQ(cache.load("airports", std::chrono::minutes(1)), std::nullopt);
+    EXPECT_EQ(warnings(), 0u);
+}
+
+TEST_F(DiskCacheTest, SectionsOlderThanTheMaxAgeAreIgnored)
+{
+    auto now = std::chrono::system_clock::now();
+    write("stands", "CFRC", DiskCache::CACHE_FORMAT_VERSION, now - std::chrono::minutes(30), DiskCache::encodeRecords(RECORDS));
+    EXPECT_EQ(cache.load("stands", std::chrono::minutes(29)), std::nullopt);
+    EXPECT_EQ(cache.load("stands", std::chrono::minutes(31)), RECORDS);
+    EXPECT_EQ(warnings(), 0u);
+}
+
+TEST_F(DiskCacheTest, OtherMagicOrVersionIsIgnored)
+{
+    auto now = std::chrono::system_clock::now();
+    std::string payload = DiskCache::encodeRecords(RECORDS);
+    write("magic", "CFRX", DiskCache::CACHE_FORMAT_VERSION, now, payload);
+    write("version", "CFRC", DiskCache::CACHE_FORMAT_VERSION + 1, now, payload);
+    write("valid", "CFRC", DiskCache::CACHE_FORMAT_VERSION, now, payload);
+    EXPECT_EQ(cache.load("magic", std::chrono::minutes(1)), std::nullopt);
+    EXPECT_EQ(cache.load("version", std::chrono::minutes(1)), std::nullopt);
+    EXPECT_EQ(cache.load("valid", std::chrono::minutes(1)), RECORDS);
+    EXPECT_EQ(warnings(), 2u);
+}
+
+TEST_F(DiskCacheTest, TruncatedOrCorruptSectionsAreIgnored)
+{
+    cache.save("stands", RECORDS);
+    auto path = directory / "stands.cache";
+    auto size = std::filesystem::file_size(path);
+
+    std::filesystem::resize_file(path, size - 1);
+    EXPECT_EQ(cache.load("stands", std::chrono::minutes(1)), std::nullopt);
+    std::filesystem::resize_file(path, 10); // Inside the header
+    EXPECT_EQ(cache.load("stands", std::chrono::minutes(1)), std::nullopt);
+
+    cache.save("stands", RECORDS);
+    std::ofstream(path, std::ios::binary | std::ios::app) << "garbage";
+    EXPECT_EQ(cache.load("stands", std::chrono::minutes(1)), std::nullopt);
+    EXPECT_EQ(warnings(), 1u); // The same warning three times, folded by the logger
+    EXPECT_EQ(metrics.counter("log.suppressed").value(), 2u);
+}
@@ -0,0 +1,172 @@
+// GateAssignerTest.cpp
+#include <gtest/gtest.h>
+#include "Harness.h"
+#include "StandInServer.h"
+
+namespace
+{
+    Config::Config standInConfig(const StandInServer::StandInServer &server)
+    {
+        Config::Config config;
+        config.gateAssignerApiBase = server.baseUrl();
+        config.gatePollingIntervalSec = 1;
+        return config;
+    }
+
+    // Arrival inside the query range of its destination
+    void addArrival(Harness::Plugin &plugin, const std::string &callsign, const std::string &destination)
+    {
+        PluginSDK::Flightplan::Flightplan flightplan;
+        flightplan.callsign = callsign;
+        flightplan.origin = "EGLL";
+        flightplan.destination = destination;
+        flightplan.wakeCategory = "M";
+        flightplan.isValid = true;
+        plugin.traffic.setFlightplan(flightplan);
+
+        PluginSDK::Aircraft::Aircraft aircraft;
+        aircraft.callsign = callsign;
+        aircraft.position.groundSpeed = 180;
+        plugin.traffic.setAircraft(aircraft, 12.0);
+    }
+
+    std::string gateOf(Harness::Plugin &plugin, const std::string &callsign)
+    {
+        auto value = plugin.tags.get(GateAssigner::GATE_ASSIGNER_TAG, callsign);
+        return value ? value->value : "";
+    }
+}
+
+TEST(GateAssignerTest, QueriesTheConfiguredApiBase)
+{
+    StandInServer::StandInServer server;
+    server.setAirports({"LFPG"}, false);
+    server.setStand("AFR123", "E22");
+    Harness::Plugin plugin(standInConfig(server));
+    addArrival(plugin, "AFR123", "LFPG");
+
+    plugin.gateAssigner().startPoller();
+
+    ASSERT_TRUE(Harness::waitFor([&]() { return gateOf(plugin, "AFR123") == "E22"; }));
+    EXPECT_EQ(server.requests(StandInServer::StandInServer::AIRPORTS), 1u);
+    EXPECT_EQ(server.requests(StandInServer::StandInServer::QUERY), 1u);
+}
+
+TEST(GateAssignerTest, BatchQueryCoversAllDueArrivals)
+{
+    StandInServer::StandInServer server;
+    server.setAirports({"LFPG"}, true);
+    server.setStand("AFR1", "E1");
+    server.setStand("AFR2", "E2");
+    server.setStand("AFR3", "E3");
+    Harness::Plugin plugin(standInConfig(server));
+    addArrival(plugin, "AFR1", "LFPG");
+    addArrival(plugin, "AFR2", "LFPG");
+    addArrival(plugin, "AFR3", "LFPG");
+
+    plugin.gateAssigner().startPoller();
+
+    ASSERT_TRUE(Harness::waitFor([&]() { return gateOf(plugin, "AFR1") == "E1" && gateOf(plugin, "AFR2") == "E2" && gateOf(plugin, "AFR3") == "E3"; }));
+    EXPECT_EQ(server.requests(StandInServer::StandInServer::BATCH), 1u);
+    EXPECT_EQ(server.batchSizes(), std::vector<size_t>({3}));
+    EXPECT_EQ(server.requests(StandInServer::StandInServer::QUERY), 0u);
+    EXPECT_EQ(plugin.metrics.counter("gate.batched_queries").value(), 3u);
+}
+
+TEST(GateAssignerTest, QueriesFlightByFlightWithoutBatchSupport)
+{
+    StandInServer::StandInServer server;
+    server.setAirports({"LFPG"}, false);
+    server.setStand("AFR1", "E1");
+    server.setStand("AFR2", "E2");
+    server.setStand("AFR3", "E3");
+    Harness::Plugin plugin(standInConfig(server));
+    addArrival(plugin, "AFR1", "LFPG");
+    addArrival(plugin, "AFR2", "LFPG");
+    addArrival(plugin, "AFR3", "LFPG");
+
+    plugin.gateAssigner().startPoller();
+
+    ASSERT_TRUE(Harness::waitFor([&]() { return gateOf(plugin, "AFR1") == "E1" && gateOf(plugin, "AFR2") == "E2" && gateOf(plugin, "AFR3") == "E3"; }));
+    EXPECT_EQ(server.requests(StandInServer::StandInServer::QUERY), 3u);
+    EXPECT_EQ(server.requests(StandInServer::StandInServer::BATCH), 0u);
+}
+
+TEST(GateAssignerTest, FallsBackToSingleQueriesWhenBatchIsNotServed)
+{
+    StandInServer::StandInServer server;
+    server.setAirports({"LFPG"}, true);
+    server.setStatus(StandInServer::StandInServer::BATCH, 404);
+    server.setStand("AFR1", "E1");
+    server.setStand("AFR2", "E2");
+    Harness::Plugin plugin(standInConfig(server));
+    addArrival(plugin, "AFR1", "LFPG");
+    addArrival(plugin, "AFR2", "LFPG");
+
+    plugin.gateAssigner().startPoller();
+
+    ASSERT_TRUE(Harness::waitFor([&]() { return gateOf(plugin, "AFR1") == "E1" && gateOf(plugin, "AFR2") == "E2"; }));
+    EXPECT_EQ(server.requests(StandInServer::StandInServer::BATCH), 1u);
+    EXPECT_EQ(server.requests(StandInServer::StandInServer::QUERY), 2u);
+    EXPECT_EQ(plugin.metrics.gauge("GateAssigner API.breaker.state").value(), static_cast<int64_t>(CircuitBreaker::State::Closed));
+}
+
+TEST(GateAssignerTest, MalformedBatchEntryIsSkippedAndCounted)
+{
+    StandInServer::StandInServer server;
+    server.setAirports({"LFPG"}, true);
+    server.setBatchBody("[data.stands]\nAFR1 = \"E1\"\nAFR2 = 12\nAFR3 = \"E3\"\n");
+    Harness::Plugin plugin(standInConfig(server));
+    addArrival(plugin, "AFR1", "LFPG");
+    addArrival(plugin, "AFR2", "LFPG");
+    addArrival(plugin, "AFR3", "LFPG");
+
+    plugin.gateAssigner().startPoller();
+
+    ASSERT_TRUE(Harness::waitFor([&]() { return gateOf(plugin, "AFR1") == "E1" && gateOf(plugin, "AFR3") == "E3"; }));
+    EXPECT_EQ(gateOf(plugin, "AFR2"), "");
+    EXPECT_EQ(plugin.metrics.counter("gate.parse_failures").value(), 1u);
+}
+
+TEST(GateAssignerTest, SlowStandQueryIsAbandonedAtTheDeadline)
+{
+    StandInServer::StandInServer server;
+    server.setAirports({"LFPG"}, false);
+    server.setStand("AFR1", "E1");
+    server.setDelay(StandInServer::StandInServer::QUERY, GateAssigner::REQUEST_DEADLINE + std::chrono::seconds(2));
+    Harness::Plugin plugin(standInConfig(server));
+    addArrival(plugin, "AFR1", "LFPG");
+    auto &failures = plugin.metrics.counter("http.stand_query.failures");
+    auto &latency = plugin.metrics.histogram("http.stand_query.latency_us");
+
+    plugin.gateAssigner().startPoller();
+
+    // Given up at the read deadline, not when the stand-in finally answers
+    ASSERT_TRUE(Harness::waitFor([&]() { return failures.value() == 1; }, GateAssigner::REQUEST_DEADLINE + std::chrono::seconds(5)));
+    auto deadline = std::chrono::duration_cast<std::chrono::microseconds>(GateAssigner::REQUEST_DEADLINE);
+    EXPECT_GE(latency.max(), static_cast<uint64_t>(deadline.count()) * 9 / 10);
+    EXPECT_LT(latency.max(), static_cast<uint64_t>((deadline + std::chrono::seconds(1)).count()));
+    EXPECT_EQ(gateOf(plugin, "AFR1"), "");
+}
+
+TEST(GateAssignerTest, FetcherQueriesArrivalsOnlyAFollowerSees)
+{
+    StandInServer::StandInServer server;
+    server.setAirports({"LFPG"}, false);
+    server.setStand("AFR9", "E9");
+    Harness::Plugin fetcher(standInConfig(server));
+    fetcher.gateAssigner().startPoller();
+    ASSERT_TRUE(Harness::waitFor([&]() { return server.requests(StandInServer::StandInServer::AIRPORTS) == 1; }));
+
+    Harness::Plugin follower(standInConfig(server), fetcher.directory);
+    addArrival(follower, "AFR9", "LFPG");
+    follower.gateAssigner().startPoller();
+
+    ASSERT_TRUE(Harness::waitFor([&]() { return gateOf(follower, "AFR9") == "E9"; }));
+    EXPECT_EQ(server.requests(StandInServer::StandInServer::AIRPORTS), 1u);
+    EXPECT_EQ(server.requests(StandInServer::StandInServer::QUERY), 1u);
+
+    // The fetcher does not see the arrival, it keeps the stand while the follower asks for it
+    fetcher.gateAssigner().stopPoller();
+    EXPECT_EQ(fetcher.diskCache.load(GateAssigner::STANDS_CACHE_SECTION, GateAssigner::STANDS_CACHE_MAX_AGE).value_or(std::vector<DiskCache::Record>()).size(), 1u);
+}
@@ -0,0 +1,70 @@
+// HttpClientPoolTest.cpp
+#include <gtest/gtest.h>
+#include "HttpClientPool.h"
+#include "StandInServer.h"
+
+TEST(HttpClientPoolTest, SequentialRequestsReuseOneConnection)
+{
+    StandInServer::StandInServer server;
+    server.setAirports({"LFPG"}, false);
+    HttpClientPool::HttpClientPool pool;
+
+    for (int i = 0; i < 5; i++)
+    {
+        auto cli = pool.acquire(server.baseUrl());
+        auto result = cli->Get("/api/cfr/stand");
+        ASSERT_TRUE(result);
+        EXPECT_EQ(result->status, 200);
+    }
+
+    EXPECT_EQ(server.requests(StandInServer::StandInServer::AIRPORTS), 5u);
+    EXPECT_EQ(server.connections(), 1u);
+}
+
+TEST(HttpClientPoolTest, ConcurrentLeasesUseTheirOwnConnection)
+{
+    StandInServer::StandInServer server;
+    server.setAirports({"LFPG"}, false);
+    HttpClientPool::HttpClientPool pool;
+
+    {
+        auto first = pool.acquire(server.baseUrl());
+        auto second = pool.acquire(server.baseUrl());
+        ASSERT_TRUE(first->Get("/api/cfr/stand"));
+        ASSERT_TRUE(second->Get("/api/cfr/stand"));
+    }
+    EXPECT_EQ(server.connections(), 2u);
+
+    // Both clients went back to the pool with their connection open
+    for (int i = 0; i < 4; i++)
+    {
+        auto cli = pool.acquire(server.baseUrl());
+        ASSERT_TRUE(cli->Get("/api/cfr/stand"));
+    }
+    EXPECT_EQ(server.connections(), 2u);
+}
+
+TEST(HttpClientPoolTest, IdleClientsAreCappedPerHost)
+{
+    StandInServer::StandInServer server;
+    server.setAirports({"LFPG"}, false);
+    HttpClientPool::Options options;
+    options.maxIdleClientsPerHost = 1;
+    HttpClientPool::HttpClientPool pool(options);
+
+    {
+        auto first = pool.acquire(server.baseUrl());
+        auto second = pool.acquire(server.baseUrl());
+        ASSERT_TRUE(first->Get("/api/cfr/stand"));
+        ASSERT_TRUE(second->Get("/api/cfr/stand"));
+    }
+
+    // Only one of the two was kept, the next two concurrent leases need one new connection
+    {
+        auto first = pool.acquire(server.baseUrl());
+        auto second = pool.acquire(server.baseUrl());
+        ASSERT_TRUE(first->Get("/api/cfr/stand"));
+        ASSERT_TRUE(second->Get("/api/cfr/stand"));
+    }
+    EXPECT_EQ(server.connections(), 3u);
+}
@@ -0,0 +1,82 @@
+// IcaoClassifierTest.cpp
+#include <regex>
+#include <string>
+#include <gtest/gtest.h>
+#include "OceanicClearance.h"
+
+namespace
+{
+    // Upper-case letters plus a lower-case letter and a digit, which the regex rejects
+    const std::string ALPHABET = "ABCDEFGHIJKLMNOPQRSTUVWXYZa0";
+
+    // Destination check replaced by OCEANIC_DESTINATIONS
+    const std::regex OCEANIC_DESTINATION_REGEX("([KCPTSMN][A-Z]{3}|LFVP|LFVM)");
+
+    // Every string of the given length over the alphabet
+    template <typename Check>
+    void forEachString(size_t length, Check check)
+    {
+        std::string value(length, ALPHABET[0]);
+        std::vector<size_t> digits(length, 0);
+        while (true)
+        {
+            check(value);
+            size_t position = 0;
+            while (position < length && ++digits[position] == ALPHABET.size())
+            {
+                digits[position] = 0;
+                value[position] = ALPHABET[0];
+                position++;
+            }
+            if (position == length)
+            {
+                return;
+            }
+            value[position] = ALPHABET[digits[position]];
+        }
+    }
+}
+
+TEST(IcaoClassifierTest, MatchesTheReplacedRegexOnEveryFourCharacterCode)
+{
+    size_t checked = 0;
+    size_t matched = 0;
+    forEachString(4, [&](const std::string &icao)
+    {
+        bool expected = std::regex_match(icao, OCEANIC_DESTINATION_REGEX);
+        ASSERT_EQ(OceanicClearance::OCEANIC_DESTINATIONS.matches(icao), expected) << icao;
+        checked++;
+        matched += expected;
+    });
+    EXPECT_EQ(checked, ALPHABET.size() * ALPHABET.size() * ALPHABET.size() * ALPHABET.size());
+    EXPECT_EQ(matched, 7u * 26 * 26 * 26 + 2);
+}
+
+TEST(IcaoClassifierTest, MatchesTheReplacedRegexOnOtherLengths)
+{
+    for (size_t length : {0, 1, 2, 3, 5})
+    {
+        forEachString(length, [](const std::string &icao)
+        {
+            ASSERT_EQ(OceanicClearance::OCEANIC_DESTINATIONS.matches(icao), std::regex_match(icao, OCEANIC_DESTINATION_REGEX)) << icao;
+        });
+    }
+}
+
+TEST(IcaoClassifierTest, RuntimeRules)
+{
+    IcaoClassifier::IcaoClassifier classifier = OceanicClearance::OCEANIC_DESTINATIONS;
+    EXPECT_FALSE(classifier.matches("EGLL"));
+    EXPECT_FALSE(classifier.matches("LFRB"));
+
+    EXPECT_TRUE(classifier.addRule("E"));
+    EXPECT_TRUE(classifier.addRule("LFR"));
+    EXPECT_TRUE(classifier.matches("EGLL"));
+    EXPECT_TRUE(classifier.matches("LFRB"));
+    EXPECT_FALSE(classifier.matches("LFPG"));
+
+    EXPECT_FALSE(classifier.addRule(""));
+    EXPECT_FALSE(classifier.addRule("LFPGX"));
+    EXPECT_FALSE(classifier.addRule("lf"));
+    EXPECT_FALSE(classifier.addRule("L1"));
+}
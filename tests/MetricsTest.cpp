@@ -0,0 +1,111 @@
+// MetricsTest.cpp
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "Metrics.h"
+
+namespace
+{
+    // Upper edge of the bucket holding value: the median of value and a much larger one
+    uint64_t upperEdgeOf(uint64_t value)
+    {
+        Metrics::Histogram histogram;
+        histogram.record(value);
+        histogram.record(UINT64_MAX);
+        return histogram.percentile(50);
+    }
+}
+
+TEST(MetricsTest, SmallValuesHaveABucketEach)
+{
+    for (uint64_t value = 0; value < 2 * Metrics::Histogram::SUB_BUCKETS; value++)
+    {
+        EXPECT_EQ(upperEdgeOf(value), value);
+    }
+}
+
+TEST(MetricsTest, BucketsDoubleInWidthEveryPowerOfTwo)
+{
+    // 16 to 31 in buckets of 2, 32 to 63 in buckets of 4
+    EXPECT_EQ(upperEdgeOf(16), 17u);
+    EXPECT_EQ(upperEdgeOf(17), 17u);
+    EXPECT_EQ(upperEdgeOf(18), 19u);
+    EXPECT_EQ(upperEdgeOf(31), 31u);
+    EXPECT_EQ(upperEdgeOf(32), 35u);
+    EXPECT_EQ(upperEdgeOf(35), 35u);
+    EXPECT_EQ(upperEdgeOf(36), 39u);
+    EXPECT_EQ(upperEdgeOf(1000), 1023u);
+    EXPECT_EQ(upperEdgeOf(1024), 1151u);
+
+    // The last bucket reaches the largest value
+    EXPECT_EQ(upperEdgeOf(UINT64_MAX - 1), UINT64_MAX);
+    EXPECT_EQ(upperEdgeOf(uint64_t(15) << 60), UINT64_MAX);
+    EXPECT_EQ(upperEdgeOf((uint64_t(15) << 60) - 1), (uint64_t(15) << 60) - 1);
+
+    // Within 12.5% of the value everywhere
+    for (uint64_t value = 1; value < (uint64_t(1) << 40); value = value * 3 / 2 + 1)
+    {
+        uint64_t upper = upperEdgeOf(value);
+        EXPECT_GE(upper, value);
+        EXPECT_LE(upper - value, value / Metrics::Histogram::SUB_BUCKETS) << value;
+    }
+}
+
+TEST(MetricsTest, PercentilesAreTheUpperEdgeCappedByTheMax)
+{
+    Metrics::Histogram histogram;
+    EXPECT_EQ(histogram.percentile(50), 0u);
+    EXPECT_EQ(histogram.mean(), 0u);
+
+    for (uint64_t value = 1; value <= 100; value++)
+    {
+        histogram.record(value);
+    }
+    EXPECT_EQ(histogram.count(), 100u);
+    EXPECT_EQ(histogram.max(), 100u);
+    EXPECT_EQ(histogram.mean(), 50u);
+    EXPECT_EQ(histogram.percentile(0), 1u); // At least one sample is counted
+    EXPECT_EQ(histogram.percentile(10), 10u);
+    EXPECT_EQ(histogram.percentile(50), 51u); // 48 to 51
+    EXPECT_EQ(histogram.percentile(90), 95u); // 88 to 95
+    EXPECT_EQ(histogram.percentile(99), 100u); // 96 to 103, capped
+    EXPECT_EQ(histogram.percentile(100), 100u);
+}
+
+TEST(MetricsTest, DurationsAreRecordedInMicroseconds)
+{
+    Metrics::Histogram histogram;
+    histogram.record(std::chrono::milliseconds(3));
+    histogram.record(std::chrono::nanoseconds(999));
+    histogram.record(std::chrono::steady_clock::duration(-std::chrono::seconds(1))); // Clamped to 0
+    EXPECT_EQ(histogram.count(), 3u);
+    EXPECT_EQ(histogram.max(), 3000u);
+    EXPECT_EQ(histogram.percentile(66), 0u); // Both below a microsecond
+    EXPECT_EQ(histogram.percentile(67), 3000u);
+}
+
+TEST(MetricsTest, ConcurrentRecordsAreAllCounted)
+{
+    Metrics::Histogram histogram;
+    const uint64_t perThread = 100000;
+    std::vector<std::thread> threads;
+    for (uint64_t t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&histogram, t]()
+        {
+            for (uint64_t i = 0; i < perThread; i++)
+            {
+                histogram.record(t * perThread + i);
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(histogram.count(), 4 * perThread);
+    EXPECT_EQ(histogram.max(), 4 * perThread - 1);
+    EXPECT_EQ(histogram.mean(), (4 * perThread - 1) / 2);
+}
@@ -0,0 +1,144 @@
+// OceanicClearanceTest.cpp
+#include <cmath>
+#include <gtest/gtest.h>
+#include "Harness.h"
+#include "StandInServer.h"
+
+namespace
+{
+    Config::Config standInConfig(const StandInServer::StandInServer &server)
+    {
+        Config::Config config;
+        config.nattrakApiBase = server.baseUrl();
+        return config;
+    }
+
+    // Westbound departure leaving through LAPEX, expanded route included
+    PluginSDK::Flightplan::Flightplan oceanicFlightplan(const std::string &callsign, const std::string &destination)
+    {
+        PluginSDK::Flightplan::Flightplan flightplan;
+        flightplan.callsign = callsign;
+        flightplan.origin = "LFPG";
+        flightplan.destination = destination;
+        flightplan.wakeCategory = "H";
+        flightplan.isValid = true;
+        flightplan.plannedAltitude = 36000;
+        flightplan.route.rawRoute = "EVX DCT LAPEX DCT 49N015W";
+        flightplan.route.waypoints = {{"EVX", {49.3, 1.0}}, {"LAPEX", {48.5, -8.0}}, {"49N015W", {49.0, -15.0}}};
+        return flightplan;
+    }
+
+    // Aircraft the given number of minutes before LAPEX at 480 kt
+    PluginSDK::Aircraft::Aircraft aircraftBeforeExit(const std::string &callsign, int minutes)
+    {
+        PluginSDK::Aircraft::Aircraft aircraft;
+        aircraft.callsign = callsign;
+        aircraft.position.groundSpeed = 480;
+        aircraft.position.latitude = 48.5;
+        aircraft.position.longitude = -8.0 + minutes * 8.0 / 60.0 / std::cos(48.5 * 3.14159265 / 180.0);
+        return aircraft;
+    }
+
+    std::optional<FakeSdk::Tags::Value> flagOf(Harness::Plugin &plugin, const std::string &callsign)
+    {
+        return plugin.tags.get(OceanicClearance::OCEANIC_FLAG_TAG, callsign);
+    }
+}
+
+TEST(OceanicClearanceTest, ControllerDataChangeIsEvaluatedWithoutANewSnapshot)
+{
+    StandInServer::StandInServer server;
+    server.setClearances({{"BAW1", 360, "LAPEX", "12:00"}});
+    Harness::Plugin plugin(standInConfig(server));
+    plugin.traffic.setFlightplan(oceanicFlightplan("BAW1", "KJFK"));
+    plugin.traffic.setAircraft(aircraftBeforeExit("BAW1", 60), std::nullopt);
+    plugin.traffic.setControllerData({"BAW1", 36000});
+
+    plugin.oceanicClearance().startPoller();
+    ASSERT_TRUE(Harness::waitFor([&]() { auto flag = flagOf(plugin, "BAW1"); return flag && flag->value == "OCL"; }));
+    size_t getAllCalls = plugin.traffic.flightplanAPI.getAllCalls;
+
+    plugin.traffic.setControllerData({"BAW1", 38000});
+    plugin.oceanicClearance().markDirty("BAW1");
+
+    ASSERT_TRUE(Harness::waitFor([&]() { auto flag = flagOf(plugin, "BAW1"); return flag && flag->value == "LCHG36"; }));
+    EXPECT_EQ(plugin.traffic.flightplanAPI.getAllCalls.load(), getAllCalls);
+    EXPECT_EQ(plugin.metrics.counter("oceanic.incremental_evaluations").value(), 1u);
+}
+
+TEST(OceanicClearanceTest, FlightplanChangeIsEvaluatedWithoutANewSnapshot)
+{
+    StandInServer::StandInServer server;
+    Harness::Plugin plugin(standInConfig(server));
+    plugin.traffic.setFlightplan(oceanicFlightplan("BAW2", "EGLL"));
+    plugin.traffic.setAircraft(aircraftBeforeExit("BAW2", 10), std::nullopt);
+
+    plugin.oceanicClearance().startPoller();
+    ASSERT_TRUE(Harness::waitFor([&]() { return server.requests(StandInServer::StandInServer::NATTRAK) == 1 && plugin.metrics.histogram("oceanic.cycle_us").count() == 1; }));
+    EXPECT_FALSE(flagOf(plugin, "BAW2"));
+    size_t getAllCalls = plugin.traffic.flightplanAPI.getAllCalls;
+
+    plugin.traffic.setFlightplan(oceanicFlightplan("BAW2", "KJFK"));
+    plugin.oceanicClearance().markDirty("BAW2");
+
+    ASSERT_TRUE(Harness::waitFor([&]() { auto flag = flagOf(plugin, "BAW2"); return flag && flag->value == "OCL"; }));
+    EXPECT_EQ(flagOf(plugin, "BAW2")->colour, OceanicClearance::COLOR_NO_OCEANIC_CLEARANCE);
+    EXPECT_EQ(plugin.traffic.flightplanAPI.getAllCalls.load(), getAllCalls);
+}
+
+TEST(OceanicClearanceTest, UnclearedFlightNoticeIsNotShownAsCleared)
+{
+    StandInServer::StandInServer server;
+    server.setClearances({{"BAW3", 360, "LAPEX", "12:00"}});
+    Harness::Plugin plugin(standInConfig(server));
+    plugin.traffic.setFlightplan(oceanicFlightplan("BAW3", "KJFK"));
+    plugin.traffic.setAircraft(aircraftBeforeExit("BAW3", 20), std::nullopt);
+    plugin.traffic.setControllerData({"BAW3", 36000});
+    plugin.traffic.setFlightplan(oceanicFlightplan("BAW4", "KJFK"));
+    plugin.traffic.setAircraft(aircraftBeforeExit("BAW4", 20), std::nullopt);
+    plugin.traffic.setFlightplan(oceanicFlightplan("BAW5", "KJFK"));
+    plugin.traffic.setAircraft(aircraftBeforeExit("BAW5", 10), std::nullopt);
+
+    plugin.oceanicClearance().startPoller();
+
+    ASSERT_TRUE(Harness::waitFor([&]() { return flagOf(plugin, "BAW3") && flagOf(plugin, "BAW4") && flagOf(plugin, "BAW5"); }));
+    EXPECT_EQ(flagOf(plugin, "BAW3")->colour, OceanicClearance::COLOR_OCEANIC_CLEARANCE);
+    EXPECT_EQ(flagOf(plugin, "BAW4")->value, "OCL");
+    EXPECT_EQ(flagOf(plugin, "BAW4")->colour, OceanicClearance::COLOR_OCEANIC_CLEARANCE_NOTICE);
+    EXPECT_EQ(flagOf(plugin, "BAW5")->colour, OceanicClearance::COLOR_NO_OCEANIC_CLEARANCE);
+}
+
+TEST(OceanicClearanceTest, UnchangedNattrakAnswerIsNotModifiedAndKeepsTheClearances)
+{
+    StandInServer::StandInServer server;
+    server.setClearances({{"BAW6", 360, "LAPEX", "12:00"}});
+    Config::Config config = standInConfig(server);
+    config.nattrakMinIntervalSec = 1;
+    config.nattrakMaxIntervalSec = 1;
+    config.nattrakRequestsPerMinute = 600;
+    Harness::Plugin plugin(config);
+    plugin.traffic.setFlightplan(oceanicFlightplan("BAW6", "KJFK"));
+    plugin.traffic.setAircraft(aircraftBeforeExit("BAW6", 20), std::nullopt);
+    plugin.traffic.setControllerData({"BAW6", 36000});
+
+    plugin.oceanicClearance().startPoller();
+    ASSERT_TRUE(Harness::waitFor([&]() { return server.notModified(StandInServer::StandInServer::NATTRAK) >= 2; }));
+    EXPECT_EQ(plugin.metrics.histogram("oceanic.nattrak_parse_us").count(), 1u);
+    EXPECT_EQ(plugin.metrics.gauge("oceanic.clearances").value(), 1);
+    ASSERT_TRUE(flagOf(plugin, "BAW6"));
+    EXPECT_EQ(flagOf(plugin, "BAW6")->colour, OceanicClearance::COLOR_OCEANIC_CLEARANCE);
+
+    // A new payload comes with new validators and is parsed again
+    server.setClearances({{"BAW6", 360, "LAPEX", "12:00"}, {"BAW7", 380, "LAPEX", "12:10"}});
+    ASSERT_TRUE(Harness::waitFor([&]() { return plugin.metrics.gauge("oceanic.clearances").value() == 2; }));
+    EXPECT_EQ(plugin.metrics.histogram("oceanic.nattrak_parse_us").count(), 2u);
+
+    // Answers are gzipped for clients that accept it
+    httplib::Client client(server.baseUrl());
+    client.set_decompress(false);
+    auto result = client.Get("/api/plugins", {{"Accept-Encoding", "gzip"}});
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result->get_header_value("Content-Encoding"), "gzip");
+    EXPECT_FALSE(result->get_header_value("ETag").empty());
+    EXPECT_FALSE(result->get_header_value("Last-Modified").empty());
+}
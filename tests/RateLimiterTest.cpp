@@ -0,0 +1,155 @@
+// RateLimiterTest.cpp
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "AsyncLogger.h"
+#include "FakeSdk.h"
+#include "Metrics.h"
+#include "RateLimiter.h"
+
+namespace
+{
+    class RateLimiterTest : public ::testing::Test
+    {
+        protected:
+            // Tokens granted in a row right now
+            static int acquireAll(RateLimiter::TokenBucket &bucket)
+            {
+                int granted = 0;
+                while (granted < 1000 && bucket.tryAcquire())
+                {
+                    granted++;
+                }
+                return granted;
+            }
+
+            // Back-off lines forwarded to the SDK logger so far
+            std::vector<std::string> backOffs(void)
+            {
+                asyncLogger.drain();
+                std::vector<std::string> lines;
+                for (const auto &line : logger.lines())
+                {
+                    if (line.find("asked to back off") != std::string::npos)
+                    {
+                        lines.push_back(line);
+                    }
+                }
+                return lines;
+            }
+
+            FakeSdk::Logger logger;
+            Metrics::Registry metrics;
+            AsyncLogger::AsyncLogger asyncLogger{logger, metrics};
+    };
+}
+
+TEST_F(RateLimiterTest, BurstIsGrantedAtOnceThenTheRateRefillsIt)
+{
+    RateLimiter::TokenBucket bucket("api", 600, 3, asyncLogger, metrics); // One token every 100 ms
+    EXPECT_EQ(acquireAll(bucket), 3);
+    EXPECT_EQ(metrics.counter("api.rate_limited").value(), 1u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    int refilled = acquireAll(bucket);
+    EXPECT_GE(refilled, 1);
+    EXPECT_LE(refilled, 3);
+
+    // An idle bucket never holds more than the burst
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    EXPECT_EQ(acquireAll(bucket), 3);
+}
+
+TEST_F(RateLimiterTest, BurstIsAtLeastOneRequest)
+{
+    RateLimiter::TokenBucket bucket("api", 1, 0, asyncLogger, metrics);
+    EXPECT_EQ(acquireAll(bucket), 1);
+}
+
+TEST_F(RateLimiterTest, TooManyRequestsPausesForRetryAfter)
+{
+    RateLimiter::TokenBucket bucket("api", 6000, 5, asyncLogger, metrics);
+    bucket.recordResponse(429, "1");
+    EXPECT_FALSE(bucket.tryAcquire());
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    EXPECT_FALSE(bucket.tryAcquire());
+    std::this_thread::sleep_for(std::chrono::milliseconds(700));
+    EXPECT_TRUE(bucket.tryAcquire());
+    EXPECT_EQ(backOffs(), std::vector<std::string>({"warning: api asked to back off for 1 s"}));
+}
+
+TEST_F(RateLimiterTest, TooManyRequestsWithoutAUsableRetryAfterPausesForTheDefault)
+{
+    RateLimiter::TokenBucket bucket("api", 6000, 5, asyncLogger, metrics);
+    bucket.recordResponse(429, "");
+    bucket.recordResponse(429, "Wed, 21 Oct 2026 07:28:00 GMT");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_FALSE(bucket.tryAcquire());
+    EXPECT_EQ(backOffs(), std::vector<std::string>({"warning: api asked to back off for 60 s"})); // Repeat folded by the logger
+}
+
+TEST_F(RateLimiterTest, UnavailableOnlyPausesWhenItSaysHowLong)
+{
+    RateLimiter::TokenBucket bucket("api", 6000, 5, asyncLogger, metrics);
+    bucket.recordResponse(503, "");
+    bucket.recordResponse(503, "soon");
+    bucket.recordResponse(500, "30");
+    bucket.recordResponse(200, "30");
+    EXPECT_TRUE(bucket.tryAcquire());
+    EXPECT_TRUE(backOffs().empty());
+
+    bucket.recordResponse(503, "1");
+    EXPECT_FALSE(bucket.tryAcquire());
+    std::this_thread::sleep_for(std::chrono::milliseconds(1200));
+    EXPECT_TRUE(bucket.tryAcquire());
+    EXPECT_EQ(backOffs(), std::vector<std::string>({"warning: api asked to back off for 1 s"}));
+}
+
+TEST_F(RateLimiterTest, RetryAfterIsCappedAtTenMinutes)
+{
+    EXPECT_EQ(RateLimiter::parseRetryAfter("0"), std::chrono::seconds(0));
+    EXPECT_EQ(RateLimiter::parseRetryAfter("120"), std::chrono::seconds(120));
+    EXPECT_EQ(RateLimiter::parseRetryAfter("600"), RateLimiter::MAX_RETRY_AFTER);
+    EXPECT_EQ(RateLimiter::parseRetryAfter("601"), RateLimiter::MAX_RETRY_AFTER);
+    EXPECT_EQ(RateLimiter::parseRetryAfter("86400"), RateLimiter::MAX_RETRY_AFTER);
+    EXPECT_EQ(RateLimiter::parseRetryAfter("99999999999999999999"), std::nullopt); // Out of range
+    EXPECT_EQ(RateLimiter::parseRetryAfter("-1"), std::nullopt);
+    EXPECT_EQ(RateLimiter::parseRetryAfter("12s"), std::nullopt);
+    EXPECT_EQ(RateLimiter::parseRetryAfter(" 12"), std::nullopt);
+
+    RateLimiter::TokenBucket bucket("api", 6000, 5, asyncLogger, metrics);
+    bucket.recordResponse(429, "86400");
+    bucket.recordResponse(503, "3600");
+    EXPECT_FALSE(bucket.tryAcquire());
+    EXPECT_EQ(backOffs(), std::vector<std::string>({"warning: api asked to back off for 600 s"})); // Repeat folded by the logger
+}
+
+TEST(AdaptiveIntervalTest, GrowsWhileUnchangedAndResetsOnChange)
+{
+    RateLimiter::AdaptiveInterval interval(std::chrono::milliseconds(1000), std::chrono::milliseconds(4000));
+    EXPECT_EQ(interval.current(), std::chrono::milliseconds(1000));
+    interval.recordUnchanged();
+    EXPECT_EQ(interval.current(), std::chrono::milliseconds(1500));
+    interval.recordUnchanged();
+    EXPECT_EQ(interval.current(), std::chrono::milliseconds(2250));
+    interval.recordUnchanged();
+    EXPECT_EQ(interval.current(), std::chrono::milliseconds(3375));
+    interval.recordUnchanged();
+    EXPECT_EQ(interval.current(), std::chrono::milliseconds(4000));
+    interval.recordUnchanged();
+    EXPECT_EQ(interval.current(), std::chrono::milliseconds(4000));
+
+    interval.recordChanged();
+    EXPECT_EQ(interval.current(), std::chrono::milliseconds(1000));
+    interval.recordChanged();
+    EXPECT_EQ(interval.current(), std::chrono::milliseconds(1000));
+}
+
+TEST(AdaptiveIntervalTest, MaximumBelowTheMinimumKeepsTheMinimum)
+{
+    RateLimiter::AdaptiveInterval interval(std::chrono::milliseconds(2000), std::chrono::milliseconds(500));
+    interval.recordUnchanged();
+    EXPECT_EQ(interval.current(), std::chrono::milliseconds(2000));
+}
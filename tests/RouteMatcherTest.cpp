@@ -0,0 +1,84 @@
+// RouteMatcherTest.cpp
+#include <array>
+#include <string>
+#include <string_view>
+#include <gtest/gtest.h>
+#include "OceanicClearance.h"
+#include "RouteMatcher.h"
+
+namespace
+{
+    // Enough names sharing prefixes that a few seeds collide before one fits
+    constexpr RouteMatcher::FixSet<24> LARGE_SET({
+        "AAAAA", "AAAAB", "AAAAC", "AAAAD", "AAAAE", "AAAAF", "AAAAG", "AAAAH",
+        "BBBBA", "BBBBB", "BBBBC", "BBBBD", "BBBBE", "BBBBF", "BBBBG", "BBBBH",
+        "A", "AB", "ABC", "ABCD", "ABCDEFGH", "Z1", "Z12", "Z123"});
+
+    const auto &BREST = OceanicClearance::BREST_OCEANIC_POINTS;
+}
+
+// Built at compile time, usable in constant expressions
+static_assert(OceanicClearance::BREST_OCEANIC_POINTS.find("LAPEX") == std::string_view("LAPEX"));
+static_assert(!OceanicClearance::BREST_OCEANIC_POINTS.find("PARIS"));
+
+TEST(RouteMatcherTest, SeedSearchGivesEveryFixItsOwnSlot)
+{
+    for (std::string_view fix : {"REGHI", "UMLER", "LAPEX", "BUNAV", "RIVAK", "ETIKI", "SEPAL", "SIVIR", "LARLA"})
+    {
+        EXPECT_EQ(BREST.find(fix), fix);
+    }
+    for (std::string_view fix : {"AAAAA", "AAAAH", "BBBBA", "BBBBH", "A", "AB", "ABC", "ABCD", "ABCDEFGH", "Z1", "Z12", "Z123"})
+    {
+        EXPECT_EQ(LARGE_SET.find(fix), fix);
+    }
+    EXPECT_FALSE(LARGE_SET.find("AAAAI"));
+    EXPECT_FALSE(LARGE_SET.find("ABCDE"));
+}
+
+TEST(RouteMatcherTest, OnlyWholeTokensMatch)
+{
+    EXPECT_FALSE(BREST.findFirst("XLAPEX"));
+    EXPECT_FALSE(BREST.findFirst("LAPEXX DCT"));
+    EXPECT_FALSE(BREST.findFirst("LAPE DCT APEX"));
+    EXPECT_FALSE(BREST.findFirst("N0450F350 DCT PARIS/N0450F350"));
+    EXPECT_FALSE(BREST.find(""));
+    EXPECT_FALSE(BREST.find("LAPEXLAPEX")); // Longer than any fix
+    EXPECT_FALSE(BREST.findFirst(""));
+    EXPECT_FALSE(BREST.findFirst("   "));
+    EXPECT_TRUE(BREST.findFirst("DCT LAPEX DCT"));
+    EXPECT_TRUE(BREST.findFirst("LAPEX"));
+}
+
+TEST(RouteMatcherTest, SpeedAndLevelSuffixIsStripped)
+{
+    auto match = BREST.findFirst("EVX DCT LAPEX/N0450F350 DCT 49N015W");
+    ASSERT_TRUE(match);
+    EXPECT_EQ(match->fix, "LAPEX");
+    EXPECT_FALSE(BREST.findFirst("EVX DCT N0450F350/LAPEX"));
+}
+
+TEST(RouteMatcherTest, CaseIsFolded)
+{
+    EXPECT_EQ(BREST.find("lapex"), "LAPEX");
+    EXPECT_EQ(BREST.find("LaPeX"), "LAPEX");
+    auto match = BREST.findFirst("evx dct reghi/n0450f350");
+    ASSERT_TRUE(match);
+    EXPECT_EQ(match->fix, "REGHI"); // The list entry, not the route text
+}
+
+TEST(RouteMatcherTest, FirstFixOfTheRouteIsReturnedWithItsPosition)
+{
+    // Two spaces and a tab between tokens still count as one separator
+    const std::string route = "EVX DCT  REGHI/N0450F350\tDCT LAPEX";
+    auto match = BREST.findFirst(route);
+    ASSERT_TRUE(match);
+    EXPECT_EQ(match->fix, "REGHI");
+    EXPECT_EQ(match->tokenIndex, 2u);
+    EXPECT_EQ(match->offset, 9u);
+    EXPECT_EQ(route.substr(match->offset, 5), "REGHI");
+
+    match = BREST.findFirst(" LAPEX");
+    ASSERT_TRUE(match);
+    EXPECT_EQ(match->tokenIndex, 0u);
+    EXPECT_EQ(match->offset, 1u);
+}
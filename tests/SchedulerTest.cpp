@@ -0,0 +1,154 @@
+// SchedulerTest.cpp
+#include <atomic>
+#include <thread>
+#include <gtest/gtest.h>
+#include "Scheduler.h"
+#include "WorkerPool.h"
+
+using namespace std::chrono_literals;
+
+TEST(SchedulerTest, BlockingJobDoesNotHoldBackTheOthers)
+{
+    WorkerPool::WorkerPool pool(1);
+    Scheduler::Scheduler scheduler;
+    scheduler.start();
+    std::atomic<bool> release = false;
+    std::atomic<int> shortRuns = 0;
+
+    // Stands in for a poller waiting on a slow API, the only scheduler thread stays free
+    scheduler.addBlockingJob("Blocking", 1h, 0ms, pool, [&release](const std::atomic<bool> &cancelled)
+    {
+        while (!release && !cancelled)
+        {
+            std::this_thread::sleep_for(1ms);
+        }
+    });
+    std::this_thread::sleep_for(20ms);
+    scheduler.addJob("Short", 10ms, 0ms, [&shortRuns](const std::atomic<bool> &) { shortRuns++; });
+
+    std::this_thread::sleep_for(200ms);
+    EXPECT_GE(shortRuns.load(), 5);
+    release = true;
+    scheduler.stop();
+}
+
+TEST(SchedulerTest, JobNeverOverlapsItself)
+{
+    Scheduler::Scheduler scheduler;
+    scheduler.start();
+    std::atomic<int> concurrent = 0;
+    std::atomic<int> maxConcurrent = 0;
+    std::atomic<int> runs = 0;
+
+    scheduler.addJob("Slow", 1ms, 0ms, [&](const std::atomic<bool> &)
+    {
+        int now = ++concurrent;
+        maxConcurrent = std::max(maxConcurrent.load(), now);
+        std::this_thread::sleep_for(5ms);
+        concurrent--;
+        runs++;
+    });
+
+    std::this_thread::sleep_for(100ms);
+    scheduler.stop();
+    EXPECT_GE(runs.load(), 5);
+    EXPECT_EQ(maxConcurrent.load(), 1);
+}
+
+TEST(SchedulerTest, CancelJobWaitsForTheCurrentRun)
+{
+    Scheduler::Scheduler scheduler;
+    scheduler.start();
+    std::atomic<bool> started = false;
+    std::atomic<bool> finished = false;
+
+    auto id = scheduler.addJob("Slow", 1h, 0ms, [&](const std::atomic<bool> &)
+    {
+        started = true;
+        std::this_thread::sleep_for(50ms);
+        finished = true;
+    });
+    while (!started)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    scheduler.cancelJob(id);
+    EXPECT_TRUE(finished.load());
+    scheduler.stop();
+}
+
+TEST(SchedulerTest, JobCanCancelItself)
+{
+    Scheduler::Scheduler scheduler;
+    scheduler.start();
+    std::atomic<int> runs = 0;
+    Scheduler::JobId id = 0;
+    std::atomic<bool> added = false;
+
+    id = scheduler.addJob("Once", 1ms, 0ms, [&](const std::atomic<bool> &)
+    {
+        while (!added)
+        {
+            std::this_thread::sleep_for(1ms);
+        }
+        runs++;
+        scheduler.cancelJob(id);
+    });
+    added = true;
+
+    std::this_thread::sleep_for(50ms);
+    scheduler.stop();
+    EXPECT_EQ(runs.load(), 1);
+}
+
+TEST(SchedulerTest, BlockingJobNeverOverlapsItself)
+{
+    WorkerPool::WorkerPool pool(4);
+    Scheduler::Scheduler scheduler;
+    scheduler.start();
+    std::atomic<int> concurrent = 0;
+    std::atomic<int> maxConcurrent = 0;
+    std::atomic<int> runs = 0;
+
+    scheduler.addBlockingJob("Slow", 1ms, 0ms, pool, [&](const std::atomic<bool> &)
+    {
+        int now = ++concurrent;
+        maxConcurrent = std::max(maxConcurrent.load(), now);
+        std::this_thread::sleep_for(5ms);
+        concurrent--;
+        runs++;
+    });
+
+    std::this_thread::sleep_for(100ms);
+    scheduler.stop();
+    EXPECT_GE(runs.load(), 5);
+    EXPECT_EQ(maxConcurrent.load(), 1);
+}
+
+TEST(SchedulerTest, CancelAndStopWaitForThePooledRuns)
+{
+    WorkerPool::WorkerPool pool(2);
+    Scheduler::Scheduler scheduler;
+    scheduler.start();
+    std::atomic<int> started = 0;
+    std::atomic<int> finished = 0;
+    auto slow = [&](const std::atomic<bool> &)
+    {
+        started++;
+        std::this_thread::sleep_for(50ms);
+        finished++;
+    };
+
+    auto cancelled = scheduler.addBlockingJob("Cancelled", 1h, 0ms, pool, slow);
+    scheduler.addBlockingJob("Stopped", 1h, 0ms, pool, slow);
+    while (started < 2)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    scheduler.cancelJob(cancelled);
+    EXPECT_GE(finished.load(), 1);
+    scheduler.stop();
+    EXPECT_EQ(finished.load(), 2);
+}
@@ -0,0 +1,179 @@
+// SharedCacheTest.cpp
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "AsyncLogger.h"
+#include "FakeSdk.h"
+#include "Metrics.h"
+#include "SharedCache.h"
+#ifndef _WIN32
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Cache directory of a test, the instances of every process map the same file
+    class SharedCacheTest : public ::testing::Test
+    {
+        protected:
+            void SetUp(void) override
+            {
+                directory = std::filesystem::temp_directory_path() / ("cofrance-shared-" + std::to_string(std::random_device()()));
+            }
+
+            void TearDown(void) override
+            {
+                std::error_code error;
+                std::filesystem::remove_all(directory, error);
+            }
+
+            std::filesystem::path directory;
+            FakeSdk::Logger logger;
+            Metrics::Registry metrics;
+            AsyncLogger::AsyncLogger asyncLogger{logger, metrics};
+    };
+
+    // Publish number n of the child, every field carries n so a torn read shows
+    std::vector<DiskCache::Record> recordsOf(int n)
+    {
+        return std::vector<DiskCache::Record>(n % 50 + 1, DiskCache::Record(4, std::string(n % 200 + 1, 'a' + n % 26) + std::to_string(n)));
+    }
+}
+
+#ifndef _WIN32
+TEST_F(SharedCacheTest, ReaderNeverSeesATornPublish)
+{
+    const int publishes = 5000;
+    pid_t child = fork();
+    ASSERT_NE(child, -1);
+    if (child == 0)
+    {
+        SharedCache::SharedCache cache(directory, asyncLogger);
+        for (int n = 0; n < publishes; n++)
+        {
+            cache.publish(SharedCache::Section::GateStands, recordsOf(n));
+        }
+        _exit(0);
+    }
+
+    SharedCache::SharedCache cache(directory, asyncLogger);
+    uint64_t sequence = 0;
+    size_t reads = 0;
+    int status = 0;
+    while (waitpid(child, &status, WNOHANG) == 0)
+    {
+        auto records = cache.readIfNewer(SharedCache::Section::GateStands, sequence, std::chrono::hours(1));
+        if (!records)
+        {
+            continue;
+        }
+        reads++;
+        ASSERT_FALSE(records->empty());
+        const std::string &value = records->front().front();
+        int n = std::stoi(value.substr(value.find_first_of("0123456789")));
+        EXPECT_EQ(*records, recordsOf(n));
+    }
+    EXPECT_TRUE(WIFEXITED(status));
+
+    // Whatever was interleaved, the last publish is read whole
+    auto last = cache.readIfNewer(SharedCache::Section::GateStands, sequence, std::chrono::hours(1));
+    if (last)
+    {
+        EXPECT_EQ(*last, recordsOf(publishes - 1));
+        reads++;
+    }
+    EXPECT_GT(reads, 0u);
+    EXPECT_EQ(sequence, 2u * publishes);
+}
+
+TEST_F(SharedCacheTest, AnotherInstanceTakesOverWhenTheFetcherIsKilled)
+{
+    int ready[2];
+    ASSERT_EQ(pipe(ready), 0);
+    pid_t child = fork();
+    ASSERT_NE(child, -1);
+    if (child == 0)
+    {
+        SharedCache::SharedCache cache(directory, asyncLogger);
+        bool fetcher = cache.acquireFetcher(SharedCache::Section::GateStands);
+        cache.publish(SharedCache::Section::GateStands, {{"AFR1", "E22"}});
+        char elected = fetcher ? 1 : 0;
+        if (write(ready[1], &elected, 1) != 1)
+        {
+            _exit(1);
+        }
+        pause();
+        _exit(0);
+    }
+
+    char elected = 0;
+    ASSERT_EQ(read(ready[0], &elected, 1), 1);
+    ASSERT_EQ(elected, 1);
+
+    SharedCache::SharedCache cache(directory, asyncLogger);
+    EXPECT_FALSE(cache.acquireFetcher(SharedCache::Section::GateStands));
+    EXPECT_TRUE(cache.acquireFetcher(SharedCache::Section::GateAirports)); // Sections are elected apart
+    uint64_t sequence = 0;
+    auto records = cache.readIfNewer(SharedCache::Section::GateStands, sequence, std::chrono::hours(1));
+    ASSERT_TRUE(records);
+    EXPECT_EQ(*records, std::vector<DiskCache::Record>({{"AFR1", "E22"}}));
+
+    // The operating system drops the lock with the process, the next try is elected
+    kill(child, SIGKILL);
+    int status = 0;
+    waitpid(child, &status, 0);
+    EXPECT_TRUE(WIFSIGNALED(status));
+    EXPECT_TRUE(cache.acquireFetcher(SharedCache::Section::GateStands));
+
+    // Published data outlives the fetcher, the new one carries on from its sequence
+    cache.publish(SharedCache::Section::GateStands, {{"AFR1", "E24"}});
+    records = cache.readIfNewer(SharedCache::Section::GateStands, sequence, std::chrono::hours(1));
+    ASSERT_TRUE(records);
+    EXPECT_EQ(*records, std::vector<DiskCache::Record>({{"AFR1", "E24"}}));
+    close(ready[0]);
+    close(ready[1]);
+}
+
+TEST_F(SharedCacheTest, UpdatesOfSeveralProcessesAreAllKept)
+{
+    const int processes = 4;
+    const int updates = 50;
+    std::vector<pid_t> children;
+    for (int p = 0; p < processes; p++)
+    {
+        pid_t child = fork();
+        ASSERT_NE(child, -1);
+        if (child == 0)
+        {
+            SharedCache::SharedCache cache(directory, asyncLogger);
+            for (int u = 0; u < updates; u++)
+            {
+                cache.update(SharedCache::Section::GateRequests, [p, u](std::vector<DiskCache::Record> &records)
+                {
+                    records.push_back({std::to_string(p), std::to_string(u)});
+                });
+            }
+            _exit(0);
+        }
+        children.push_back(child);
+    }
+    for (pid_t child : children)
+    {
+        int status = 0;
+        waitpid(child, &status, 0);
+        EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+
+    SharedCache::SharedCache cache(directory, asyncLogger);
+    uint64_t sequence = 0;
+    auto records = cache.readIfNewer(SharedCache::Section::GateRequests, sequence, std::chrono::hours(1));
+    ASSERT_TRUE(records);
+    EXPECT_EQ(records->size(), static_cast<size_t>(processes * updates));
+    EXPECT_EQ(sequence, 2u * processes * updates);
+}
+#endif
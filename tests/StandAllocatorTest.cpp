@@ -0,0 +1,142 @@
+// StandAllocatorTest.cpp
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <gtest/gtest.h>
+#include "AsyncLogger.h"
+#include "FakeSdk.h"
+#include "Metrics.h"
+#include "StandAllocator.h"
+
+namespace
+{
+    // Allocator over the stands of a data file written for the test
+    class StandAllocatorTest : public ::testing::Test
+    {
+        protected:
+            void TearDown(void) override
+            {
+                std::error_code error;
+                std::filesystem::remove(path, error);
+            }
+
+            void load(const std::string &data)
+            {
+                path = std::filesystem::temp_directory_path() / ("cofrance-stands-" + std::to_string(std::random_device()()) + ".toml");
+                std::ofstream(path) << data;
+                ASSERT_TRUE(allocator.load(path));
+            }
+
+            std::filesystem::path path;
+            FakeSdk::Logger logger;
+            Metrics::Registry metrics;
+            AsyncLogger::AsyncLogger asyncLogger{logger, metrics};
+            StandAllocator::StandAllocator allocator{asyncLogger};
+            StandAllocator::TimePoint t0 = std::chrono::steady_clock::now();
+    };
+}
+
+TEST_F(StandAllocatorTest, WakeCategoryRestrictsTheStands)
+{
+    load(R"(
+        [[stands]]
+        airport = "LFPG"
+        name = "F1"
+        wake = ["H", "J"]
+
+        [[stands]]
+        airport = "LFPG"
+        name = "E1"
+        wake = ["L", "M"]
+    )");
+
+    EXPECT_EQ(allocator.allocate("AFR1", "LFPG", "EGLL", "M", t0), "E1");
+    EXPECT_EQ(allocator.allocate("AFR2", "LFPG", "KJFK", "H", t0), "F1");
+    EXPECT_EQ(allocator.allocate("AFR3", "LFPG", "EGLL", "M", t0), std::nullopt); // F1 is free but too small a wake
+    EXPECT_EQ(allocator.allocate("AFR4", "LFMN", "EGLL", "M", t0), std::nullopt);
+    EXPECT_TRUE(allocator.covers("LFPG"));
+    EXPECT_FALSE(allocator.covers("LFMN"));
+}
+
+TEST_F(StandAllocatorTest, AirlinePreferenceComesBeforeOrigin)
+{
+    load(R"(
+        [[stands]]
+        airport = "LFPG"
+        name = "A1"
+
+        [[stands]]
+        airport = "LFPG"
+        name = "B1"
+        origins = ["EG"]
+
+        [[stands]]
+        airport = "LFPG"
+        name = "C1"
+        airlines = ["AFR"]
+
+        [[stands]]
+        airport = "LFPG"
+        name = "C2"
+        airlines = ["AFR"]
+        origins = ["EG"]
+    )");
+
+    EXPECT_EQ(allocator.allocate("AFR1", "LFPG", "EGLL", "M", t0), "C2");
+    EXPECT_EQ(allocator.allocate("AFR2", "LFPG", "EGLL", "M", t0), "C1");
+    EXPECT_EQ(allocator.allocate("BAW3", "LFPG", "EGLL", "M", t0), "B1");
+    EXPECT_EQ(allocator.allocate("DLH4", "LFPG", "EDDF", "M", t0), "A1");
+    EXPECT_EQ(allocator.allocate("DLH5", "LFPG", "EDDF", "M", t0), std::nullopt);
+
+    // A new allocation of the same callsign frees its previous stand first
+    EXPECT_EQ(allocator.allocate("AFR1", "LFPG", "EGLL", "M", t0), "C2");
+}
+
+TEST_F(StandAllocatorTest, OccupationsTouchingAtTheBoundaryDoNotOverlap)
+{
+    load(R"(
+        [[stands]]
+        airport = "LFPG"
+        name = "E1"
+    )");
+    const auto occupation = StandAllocator::OCCUPATION_TIME;
+
+    ASSERT_EQ(allocator.allocate("AFR1", "LFPG", "EGLL", "M", t0), "E1");
+    EXPECT_EQ(allocator.allocate("AFR2", "LFPG", "EGLL", "M", t0 + occupation - std::chrono::seconds(1)), std::nullopt);
+    EXPECT_EQ(allocator.allocate("AFR3", "LFPG", "EGLL", "M", t0 - occupation + std::chrono::seconds(1)), std::nullopt);
+    EXPECT_EQ(allocator.allocate("AFR4", "LFPG", "EGLL", "M", t0 + occupation), "E1");
+    EXPECT_EQ(allocator.allocate("AFR5", "LFPG", "EGLL", "M", t0 - occupation), "E1");
+
+    allocator.release("AFR1");
+    EXPECT_EQ(allocator.allocate("AFR2", "LFPG", "EGLL", "M", t0 + std::chrono::seconds(1)), std::nullopt); // Now overlaps AFR4
+    EXPECT_EQ(allocator.allocate("AFR6", "LFPG", "EGLL", "M", t0), "E1");
+}
+
+TEST_F(StandAllocatorTest, ConfirmedStandBumpsOverlappingProvisionalOnes)
+{
+    load(R"(
+        [[stands]]
+        airport = "LFPG"
+        name = "E1"
+
+        [[stands]]
+        airport = "LFPG"
+        name = "E2"
+    )");
+
+    ASSERT_EQ(allocator.allocate("AFR1", "LFPG", "EGLL", "M", t0), "E1");
+    ASSERT_EQ(allocator.allocate("AFR2", "LFPG", "EGLL", "M", t0 + StandAllocator::OCCUPATION_TIME), "E1");
+
+    // Overlaps AFR1 only, AFR2 starts exactly when it ends
+    EXPECT_EQ(allocator.confirm("BAW3", "LFPG", "E1", t0 - std::chrono::minutes(10)), std::vector<std::string>({"AFR1"}));
+    EXPECT_EQ(allocator.allocate("AFR1", "LFPG", "EGLL", "M", t0), "E2");
+
+    // Confirmed stands never give way to one another
+    EXPECT_TRUE(allocator.confirm("BAW4", "LFPG", "E1", t0).empty());
+
+    // Stands missing from the data file are recorded nowhere
+    EXPECT_TRUE(allocator.confirm("BAW5", "LFPG", "Z9", t0).empty());
+    EXPECT_TRUE(allocator.confirm("BAW6", "LFMN", "E1", t0).empty());
+}
@@ -0,0 +1,82 @@
+// TagUpdateQueueTest.cpp
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "FakeSdk.h"
+#include "TagUpdateQueue.h"
+
+TEST(TagUpdateQueueTest, LaterPushReplacesTheValueAndKeepsItsPlace)
+{
+    FakeSdk::Tags tags;
+    Metrics::Registry metrics;
+    TagUpdateQueue::TagUpdateQueue queue(tags, metrics);
+
+    queue.push("tag:gate", "AFR1", "E1");
+    queue.push("tag:gate", "AFR2", "E2");
+    queue.push("tag:gate", "AFR1", "E5", std::array<unsigned int, 3>{1, 2, 3});
+    queue.dispatch();
+
+    EXPECT_EQ(tags.sent(), std::vector<std::string>({"AFR1=E5", "AFR2=E2"}));
+    EXPECT_EQ(tags.get("gate", "AFR1")->colour, (std::array<unsigned int, 3>{1, 2, 3}));
+    EXPECT_EQ(metrics.counter("tags.queued").value(), 3u);
+    EXPECT_EQ(metrics.counter("tags.coalesced").value(), 1u);
+    EXPECT_EQ(metrics.counter("tags.dispatched").value(), 2u);
+}
+
+TEST(TagUpdateQueueTest, TagsOfTheSameCallsignAreKeptApart)
+{
+    FakeSdk::Tags tags;
+    Metrics::Registry metrics;
+    TagUpdateQueue::TagUpdateQueue queue(tags, metrics);
+
+    queue.push("tag:gate", "AFR1", "E1");
+    queue.push("tag:oceanic", "AFR1", "CLR");
+    queue.dispatch();
+
+    EXPECT_EQ(tags.get("gate", "AFR1")->value, "E1");
+    EXPECT_EQ(tags.get("oceanic", "AFR1")->value, "CLR");
+    EXPECT_EQ(metrics.counter("tags.coalesced").value(), 0u);
+}
+
+TEST(TagUpdateQueueTest, DispatchSendsAtMostTheCapOldestFirst)
+{
+    FakeSdk::Tags tags;
+    Metrics::Registry metrics;
+    TagUpdateQueue::TagUpdateQueue queue(tags, metrics);
+    size_t total = TagUpdateQueue::MAX_UPDATES_PER_DISPATCH * 2 + 50;
+    for (size_t i = 0; i < total; i++)
+    {
+        queue.push("tag:gate", "AFR" + std::to_string(i), "S");
+    }
+
+    queue.dispatch();
+    ASSERT_EQ(tags.sent().size(), TagUpdateQueue::MAX_UPDATES_PER_DISPATCH);
+    EXPECT_EQ(tags.sent().front(), "AFR0=S");
+    EXPECT_EQ(tags.sent().back(), "AFR" + std::to_string(TagUpdateQueue::MAX_UPDATES_PER_DISPATCH - 1) + "=S");
+    EXPECT_EQ(metrics.gauge("tags.queue_depth").value(), static_cast<int64_t>(total - TagUpdateQueue::MAX_UPDATES_PER_DISPATCH));
+
+    queue.dispatch();
+    queue.dispatch();
+    EXPECT_EQ(tags.sent().size(), total);
+    EXPECT_EQ(tags.sent().back(), "AFR" + std::to_string(total - 1) + "=S");
+    EXPECT_EQ(metrics.gauge("tags.queue_depth").value(), 0);
+
+    queue.dispatch();
+    EXPECT_EQ(tags.sent().size(), total);
+}
+
+TEST(TagUpdateQueueTest, ClearDropsTheWaitingUpdates)
+{
+    FakeSdk::Tags tags;
+    Metrics::Registry metrics;
+    TagUpdateQueue::TagUpdateQueue queue(tags, metrics);
+
+    queue.push("tag:gate", "AFR1", "E1");
+    queue.clear();
+    queue.dispatch();
+    queue.push("tag:gate", "AFR1", "E2");
+    queue.dispatch();
+
+    EXPECT_EQ(tags.sent(), std::vector<std::string>({"AFR1=E2"}));
+    EXPECT_EQ(metrics.counter("tags.coalesced").value(), 0u);
+}
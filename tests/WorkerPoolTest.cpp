@@ -0,0 +1,84 @@
+// WorkerPoolTest.cpp
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "WorkerPool.h"
+
+using namespace std::chrono_literals;
+
+TEST(WorkerPoolTest, ParallelForRunsEveryIndexOnce)
+{
+    WorkerPool::WorkerPool pool(4);
+    std::vector<std::atomic<int>> runs(1000);
+
+    pool.parallelFor(runs.size(), 4, [&runs](size_t i) { runs[i]++; });
+
+    for (const auto &count : runs)
+    {
+        EXPECT_EQ(count.load(), 1);
+    }
+}
+
+TEST(WorkerPoolTest, ParallelForKeepsToMaxWorkers)
+{
+    WorkerPool::WorkerPool pool(8);
+    std::atomic<int> concurrent = 0;
+    std::atomic<int> maxConcurrent = 0;
+
+    pool.parallelFor(16, 3, [&](size_t)
+    {
+        int now = ++concurrent;
+        maxConcurrent = std::max(maxConcurrent.load(), now);
+        std::this_thread::sleep_for(5ms);
+        concurrent--;
+    });
+
+    EXPECT_LE(maxConcurrent.load(), 3);
+    EXPECT_GE(maxConcurrent.load(), 2);
+}
+
+TEST(WorkerPoolTest, ParallelForFinishesOnTheCallerWhenThePoolIsBusy)
+{
+    WorkerPool::WorkerPool pool(1);
+    std::atomic<bool> release = false;
+    pool.submit([&release]()
+    {
+        while (!release)
+        {
+            std::this_thread::sleep_for(1ms);
+        }
+    });
+
+    std::atomic<int> runs = 0;
+    pool.parallelFor(10, 4, [&runs](size_t) { runs++; });
+
+    EXPECT_EQ(runs.load(), 10);
+    release = true;
+}
+
+TEST(WorkerPoolTest, NestedParallelForDoesNotDeadlock)
+{
+    WorkerPool::WorkerPool pool(2);
+    std::atomic<int> runs = 0;
+
+    pool.parallelFor(4, 4, [&](size_t)
+    {
+        pool.parallelFor(4, 4, [&runs](size_t) { runs++; });
+    });
+
+    EXPECT_EQ(runs.load(), 16);
+}
+
+TEST(WorkerPoolTest, QueuedTasksRunBeforeDestruction)
+{
+    std::atomic<int> runs = 0;
+    {
+        WorkerPool::WorkerPool pool(1);
+        for (int i = 0; i < 20; i++)
+        {
+            pool.submit([&runs]() { std::this_thread::sleep_for(1ms); runs++; });
+        }
+    }
+    EXPECT_EQ(runs.load(), 20);
+}
@@ -0,0 +1,227 @@
+// FakeSdk.h
+#pragma once
+#include <array>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include <NeoRadarSDK/SDK.h>
+
+namespace FakeSdk
+{
+    // Keeps every line, tests look for expected messages
+    class Logger : public PluginSDK::Logger::LoggerAPI
+    {
+        public:
+            void info(const std::string &message) override { add("info", message); }
+            void warning(const std::string &message) override { add("warning", message); }
+            void error(const std::string &message) override { add("error", message); }
+            void debug(const std::string &message) override { add("debug", message); }
+
+            std::vector<std::string> lines(void)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return lines_;
+            }
+
+        private:
+            std::mutex mutex_;
+            std::vector<std::string> lines_;
+
+            void add(const std::string &level, const std::string &message)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                lines_.push_back(level + ": " + message);
+            }
+    };
+
+    // Tag values as the client would show them, keyed by tag id then callsign
+    class Tags : public PluginSDK::Tag::TagInterface, public PluginSDK::Tag::TagAPI
+    {
+        public:
+            struct Value
+            {
+                std::string value;
+                std::optional<std::array<unsigned int, 3>> colour;
+            };
+
+            std::string RegisterTagItem(const PluginSDK::Tag::TagItemDefinition &definition) override
+            {
+                return "tag:" + definition.name;
+            }
+
+            void UpdateTagValue(const std::string &tagId, const std::string &value, const PluginSDK::Tag::TagContext &context) override
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                values_[tagId][context.callsign] = Value{value, context.colour};
+                sent_.push_back(context.callsign + "=" + value);
+                updates++;
+            }
+
+            PluginSDK::Tag::TagInterface *getInterface() override { return this; }
+
+            std::optional<Value> get(const std::string &tagName, const std::string &callsign)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto tag = values_.find("tag:" + tagName);
+                if (tag == values_.end() || !tag->second.contains(callsign))
+                {
+                    return std::nullopt;
+                }
+                return tag->second.at(callsign);
+            }
+
+            // Every update as "callsign=value", in the order the client got them
+            std::vector<std::string> sent(void)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return sent_;
+            }
+
+            std::atomic<size_t> updates = 0;
+
+        private:
+            std::mutex mutex_;
+            std::map<std::string, std::map<std::string, Value>> values_;
+            std::vector<std::string> sent_;
+    };
+
+    // Traffic served to the snapshot provider, editable from the test thread. The SDK
+    // interfaces share method names, so each one is implemented by its own view.
+    class Traffic
+    {
+        public:
+            void setFlightplan(const PluginSDK::Flightplan::Flightplan &flightplan)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                flightplans_[flightplan.callsign] = flightplan;
+            }
+
+            void removeFlightplan(const std::string &callsign)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                flightplans_.erase(callsign);
+            }
+
+            void removeAircraft(const std::string &callsign)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                aircraft_.erase(callsign);
+                distances_.erase(callsign);
+            }
+
+            void setAircraft(const PluginSDK::Aircraft::Aircraft &aircraft, std::optional<double> distanceToDestination)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                aircraft_[aircraft.callsign] = aircraft;
+                distances_[aircraft.callsign] = distanceToDestination;
+            }
+
+            void setControllerData(const PluginSDK::ControllerData::ControllerDataModel &controllerData)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                controllerData_[controllerData.callsign] = controllerData;
+            }
+
+            class Aircraft : public PluginSDK::Aircraft::AircraftAPI
+            {
+                public:
+                    explicit Aircraft(Traffic &traffic) : traffic_(traffic) {}
+
+                    std::optional<double> getDistanceToDestination(const std::string &callsign) override
+                    {
+                        std::lock_guard<std::mutex> lock(traffic_.mutex_);
+                        auto it = traffic_.distances_.find(callsign);
+                        return it != traffic_.distances_.end() ? it->second : std::nullopt;
+                    }
+
+                    std::vector<PluginSDK::Aircraft::Aircraft> getAll() override
+                    {
+                        std::lock_guard<std::mutex> lock(traffic_.mutex_);
+                        getAllCalls++;
+                        std::vector<PluginSDK::Aircraft::Aircraft> all;
+                        for (const auto &[callsign, aircraft] : traffic_.aircraft_)
+                        {
+                            all.push_back(aircraft);
+                        }
+                        return all;
+                    }
+
+                    std::optional<PluginSDK::Aircraft::Aircraft> getByCallsign(const std::string &callsign) override
+                    {
+                        std::lock_guard<std::mutex> lock(traffic_.mutex_);
+                        auto it = traffic_.aircraft_.find(callsign);
+                        return it != traffic_.aircraft_.end() ? std::optional(it->second) : std::nullopt;
+                    }
+
+                    std::atomic<size_t> getAllCalls = 0;
+
+                private:
+                    Traffic &traffic_;
+            };
+
+            class Flightplans : public PluginSDK::Flightplan::FlightplanAPI
+            {
+                public:
+                    explicit Flightplans(Traffic &traffic) : traffic_(traffic) {}
+
+                    std::vector<PluginSDK::Flightplan::Flightplan> getAll() override
+                    {
+                        std::lock_guard<std::mutex> lock(traffic_.mutex_);
+                        getAllCalls++;
+                        std::vector<PluginSDK::Flightplan::Flightplan> all;
+                        for (const auto &[callsign, flightplan] : traffic_.flightplans_)
+                        {
+                            all.push_back(flightplan);
+                        }
+                        return all;
+                    }
+
+                    std::optional<PluginSDK::Flightplan::Flightplan> getByCallsign(const std::string &callsign) override
+                    {
+                        std::lock_guard<std::mutex> lock(traffic_.mutex_);
+                        getByCallsignCalls++;
+                        auto it = traffic_.flightplans_.find(callsign);
+                        return it != traffic_.flightplans_.end() ? std::optional(it->second) : std::nullopt;
+                    }
+
+                    std::atomic<size_t> getAllCalls = 0;
+                    std::atomic<size_t> getByCallsignCalls = 0;
+
+                private:
+                    Traffic &traffic_;
+            };
+
+            class ControllerData : public PluginSDK::ControllerData::ControllerDataAPI
+            {
+                public:
+                    explicit ControllerData(Traffic &traffic) : traffic_(traffic) {}
+
+                    std::optional<PluginSDK::ControllerData::ControllerDataModel> getByCallsign(const std::string &callsign) override
+                    {
+                        std::lock_guard<std::mutex> lock(traffic_.mutex_);
+                        getByCallsignCalls++;
+                        auto it = traffic_.controllerData_.find(callsign);
+                        return it != traffic_.controllerData_.end() ? std::optional(it->second) : std::nullopt;
+                    }
+
+                    std::atomic<size_t> getByCallsignCalls = 0;
+
+                private:
+                    Traffic &traffic_;
+            };
+
+            Aircraft aircraftAPI{*this};
+            Flightplans flightplanAPI{*this};
+            ControllerData controllerDataAPI{*this};
+
+        private:
+            std::mutex mutex_;
+            std::map<std::string, PluginSDK::Flightplan::Flightplan> flightplans_;
+            std::map<std::string, PluginSDK::Aircraft::Aircraft> aircraft_;
+            std::map<std::string, std::optional<double>> distances_;
+            std::map<std::string, PluginSDK::ControllerData::ControllerDataModel> controllerData_;
+    };
+}
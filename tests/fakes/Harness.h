@@ -0,0 +1,120 @@
+// Harness.h
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include "AsyncLogger.h"
+#include "Config.h"
+#include "DiskCache.h"
+#include "FakeSdk.h"
+#include "GateAssigner.h"
+#include "HttpClientPool.h"
+#include "Metrics.h"
+#include "OceanicClearance.h"
+#include "Scheduler.h"
+#include "SharedCache.h"
+#include "Snapshot.h"
+#include "TagUpdateQueue.h"
+#include "WorkerPool.h"
+
+namespace Harness
+{
+    // Poll until the condition holds, false after the timeout
+    inline bool waitFor(const std::function<bool()> &condition, std::chrono::milliseconds timeout = std::chrono::seconds(10))
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!condition())
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return true;
+    }
+
+    // Everything CoFrancePlugin::Initialize wires up, over the SDK fakes and a
+    // cache directory of its own. Modules are created on demand from the config.
+    // Plugins given the same cache directory share the host caches, like instances on one host.
+    class Plugin
+    {
+        public:
+            explicit Plugin(Config::Config pluginConfig, std::filesystem::path cacheDirectory = {})
+                : config(std::move(pluginConfig)),
+                  directory(!cacheDirectory.empty() ? std::move(cacheDirectory)
+                      : std::filesystem::temp_directory_path() / ("cofrance-test-" + std::to_string(std::random_device()()))),
+                  diskCache(directory, asyncLogger),
+                  sharedCache(directory, asyncLogger)
+            {
+                scheduler.start();
+                scheduler.addJob("Log drain", AsyncLogger::DRAIN_INTERVAL, std::chrono::milliseconds(0),
+                    [this](const std::atomic<bool> &) { asyncLogger.drain(); });
+                scheduler.addJob("Tag dispatch", TagUpdateQueue::DISPATCH_INTERVAL, std::chrono::milliseconds(0),
+                    [this](const std::atomic<bool> &) { tagUpdateQueue.dispatch(); });
+            }
+
+            ~Plugin()
+            {
+                if (gateAssigner_)
+                {
+                    gateAssigner_->stopPoller();
+                }
+                if (oceanicClearance_)
+                {
+                    oceanicClearance_->stopPoller();
+                }
+                scheduler.stop();
+                gateAssigner_.reset();
+                oceanicClearance_.reset();
+                asyncLogger.drain();
+                std::error_code error;
+                std::filesystem::remove_all(directory, error);
+            }
+
+            GateAssigner::GateAssigner &gateAssigner(void)
+            {
+                if (!gateAssigner_)
+                {
+                    gateAssigner_ = std::make_unique<GateAssigner::GateAssigner>(snapshotProvider, tags, tagUpdateQueue, asyncLogger,
+                        httpClientPool, scheduler, workerPool, config, metrics, diskCache, sharedCache);
+                }
+                return *gateAssigner_;
+            }
+
+            OceanicClearance::OceanicClearance &oceanicClearance(void)
+            {
+                if (!oceanicClearance_)
+                {
+                    oceanicClearance_ = std::make_unique<OceanicClearance::OceanicClearance>(snapshotProvider, tags, tagUpdateQueue, asyncLogger,
+                        httpClientPool, scheduler, workerPool, config, metrics, diskCache, sharedCache);
+                }
+                return *oceanicClearance_;
+            }
+
+            FakeSdk::Logger logger;
+            FakeSdk::Tags tags;
+            FakeSdk::Traffic traffic;
+            Config::Config config;
+            const std::filesystem::path directory; // Disk and shared caches, removed with the harness
+            Metrics::Registry metrics;
+            AsyncLogger::AsyncLogger asyncLogger{logger, metrics};
+            Scheduler::Scheduler scheduler;
+            WorkerPool::WorkerPool workerPool{std::max<size_t>(WorkerPool::DEFAULT_THREAD_COUNT, std::thread::hardware_concurrency())};
+            HttpClientPool::HttpClientPool httpClientPool;
+            Snapshot::SnapshotProvider snapshotProvider{traffic.aircraftAPI, traffic.flightplanAPI, traffic.controllerDataAPI,
+                GateAssigner::GateAssigner::snapshotMaxAge(config)};
+            TagUpdateQueue::TagUpdateQueue tagUpdateQueue{tags, metrics};
+            DiskCache::DiskCache diskCache;
+            SharedCache::SharedCache sharedCache;
+
+        private:
+            std::unique_ptr<GateAssigner::GateAssigner> gateAssigner_;
+            std::unique_ptr<OceanicClearance::OceanicClearance> oceanicClearance_;
+    };
+}
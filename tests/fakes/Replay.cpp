@@ -0,0 +1,118 @@
+// Replay.cpp
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include "Replay.h"
+
+namespace Replay
+{
+    Recording Recording::load(const std::vector<std::filesystem::path> &files)
+    {
+        Recording recording;
+        for (const auto &file : files)
+        {
+            std::ifstream input(file);
+            if (!input)
+            {
+                throw std::runtime_error("Cannot open " + file.string());
+            }
+            std::string line;
+            size_t lineNumber = 0;
+            while (std::getline(input, line))
+            {
+                lineNumber++;
+                if (line.find_first_not_of(" \t\r") == std::string::npos)
+                {
+                    continue;
+                }
+                nlohmann::json data = nlohmann::json::parse(line, nullptr, false);
+                if (!data.is_object() || !data.contains("t") || !data["t"].is_number())
+                {
+                    throw std::runtime_error(file.string() + ":" + std::to_string(lineNumber) + ": not a frame");
+                }
+                double time = data["t"].get<double>();
+                recording.frames_.push_back({time, std::move(data)});
+            }
+        }
+
+        // Files recorded side by side interleave, frames of the same time keep their file order
+        std::stable_sort(recording.frames_.begin(), recording.frames_.end(),
+            [](const Frame &a, const Frame &b) { return a.time < b.time; });
+        return recording;
+    }
+
+    double Recording::duration(void) const
+    {
+        return frames_.empty() ? 0 : frames_.back().time;
+    }
+
+    void Recording::applyUntil(double time, FakeSdk::Traffic &traffic, StandInServer::StandInServer &server,
+        const std::function<void(const std::string &callsign)> &changed)
+    {
+        for (; next_ < frames_.size() && frames_[next_].time <= time; next_++)
+        {
+            const nlohmann::json &data = frames_[next_].data;
+
+            for (const auto &entry : data.value("flightplans", nlohmann::json::array()))
+            {
+                PluginSDK::Flightplan::Flightplan flightplan;
+                flightplan.callsign = entry.at("callsign").get<std::string>();
+                flightplan.origin = entry.value("origin", "");
+                flightplan.destination = entry.value("destination", "");
+                flightplan.wakeCategory = entry.value("wake", "M");
+                flightplan.plannedAltitude = entry.value("altitude", 0);
+                flightplan.isValid = true;
+                flightplan.route.rawRoute = entry.value("route", "");
+                for (const auto &waypoint : entry.value("waypoints", nlohmann::json::array()))
+                {
+                    flightplan.route.waypoints.push_back({waypoint.at(0).get<std::string>(), {waypoint.at(1).get<double>(), waypoint.at(2).get<double>()}});
+                }
+                traffic.setFlightplan(flightplan);
+                changed(flightplan.callsign);
+            }
+
+            for (const auto &entry : data.value("aircraft", nlohmann::json::array()))
+            {
+                PluginSDK::Aircraft::Aircraft aircraft;
+                aircraft.callsign = entry.at("callsign").get<std::string>();
+                aircraft.position.latitude = entry.value("latitude", 0.0);
+                aircraft.position.longitude = entry.value("longitude", 0.0);
+                aircraft.position.groundSpeed = entry.value("groundSpeed", 0);
+                std::optional<double> distance;
+                if (entry.contains("distance") && entry["distance"].is_number())
+                {
+                    distance = entry["distance"].get<double>();
+                }
+                traffic.setAircraft(aircraft, distance);
+            }
+
+            for (const auto &entry : data.value("controllerData", nlohmann::json::array()))
+            {
+                std::string callsign = entry.at("callsign").get<std::string>();
+                traffic.setControllerData({callsign, entry.value("clearedFlightLevel", 0)});
+                changed(callsign);
+            }
+
+            for (const auto &callsign : data.value("removed", nlohmann::json::array()))
+            {
+                traffic.removeFlightplan(callsign.get<std::string>());
+                traffic.removeAircraft(callsign.get<std::string>());
+                changed(callsign.get<std::string>());
+            }
+
+            if (data.contains("airports"))
+            {
+                server.setAirports(data["airports"].value("icaos", std::vector<std::string>()), data["airports"].value("batch", false));
+            }
+            const nlohmann::json stands = data.value("stands", nlohmann::json::object());
+            for (const auto &[callsign, stand] : stands.items())
+            {
+                server.setStand(callsign, stand.get<std::string>());
+            }
+            if (data.contains("nattrak"))
+            {
+                server.setNattrakBody(data["nattrak"].dump());
+            }
+        }
+    }
+}
@@ -0,0 +1,49 @@
+// Replay.h
+#pragma once
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "FakeSdk.h"
+#include "StandInServer.h"
+
+namespace Replay
+{
+    // Recorded traffic snapshots and API answers, one JSON frame per line, times in seconds
+    // from the start of the recording. Every key of a frame is optional:
+    //   {"t": 12.5,
+    //    "flightplans": [{"callsign": "AFR1", "origin": "EGLL", "destination": "LFPG", "wake": "M",
+    //                     "altitude": 36000, "route": "BIG DCT ABB", "waypoints": [["BIG", 51.3, 0.03]]}],
+    //    "aircraft": [{"callsign": "AFR1", "latitude": 49.0, "longitude": 2.5, "groundSpeed": 250, "distance": 15.0}],
+    //    "controllerData": [{"callsign": "AFR1", "clearedFlightLevel": 36000}],
+    //    "removed": ["BAW2"],
+    //    "airports": {"icaos": ["LFPG"], "batch": true},
+    //    "stands": {"AFR1": "E22"},
+    //    "nattrak": [... Nattrak answer as recorded ...]}
+    // Flights are updated in place, a frame only needs to carry what changed.
+    class Recording
+    {
+        public:
+            // Frames of every file merged by time, throws std::runtime_error on unreadable input
+            static Recording load(const std::vector<std::filesystem::path> &files);
+
+            double duration(void) const;
+            bool finished(void) const { return next_ >= frames_.size(); }
+
+            // Apply the frames recorded up to time to the SDK fakes and the stand-in. Callsigns whose
+            // flight plan or controller data changed are reported like the SDK events would be.
+            void applyUntil(double time, FakeSdk::Traffic &traffic, StandInServer::StandInServer &server,
+                const std::function<void(const std::string &callsign)> &changed);
+
+        private:
+            struct Frame
+            {
+                double time;
+                nlohmann::json data;
+            };
+
+            std::vector<Frame> frames_;
+            size_t next_ = 0;
+    };
+}
@@ -0,0 +1,278 @@
+// StandInServer.cpp
+#include <ctime>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+#include "StandInServer.h"
+
+namespace StandInServer
+{
+    namespace
+    {
+        thread_local bool serverThread = false;
+
+        // httplib thread pool whose workers mark themselves as server threads
+        class MarkedThreadPool : public httplib::TaskQueue
+        {
+            public:
+                explicit MarkedThreadPool(size_t threadCount) : pool_(threadCount) {}
+
+                bool enqueue(std::function<void()> fn) override
+                {
+                    return pool_.enqueue([fn = std::move(fn)]() { serverThread = true; fn(); });
+                }
+
+                void shutdown() override { pool_.shutdown(); }
+
+            private:
+                httplib::ThreadPool pool_;
+        };
+    }
+
+    bool StandInServer::isServerThread(void)
+    {
+        return serverThread;
+    }
+
+    StandInServer::StandInServer()
+    {
+        server_.new_task_queue = []() { return new MarkedThreadPool(8); };
+        server_.set_keep_alive_max_count(1000); // httplib closes after 5 requests by default, real front ends keep going
+        server_.Get("/api/cfr/stand", [this](const httplib::Request &req, httplib::Response &res) { handleAirports(req, res); });
+        server_.Post("/api/cfr/stand/query", [this](const httplib::Request &req, httplib::Response &res) { handleQuery(req, res); });
+        server_.Post("/api/cfr/stand/query/batch", [this](const httplib::Request &req, httplib::Response &res) { handleBatch(req, res); });
+        server_.Get("/api/plugins", [this](const httplib::Request &req, httplib::Response &res) { handleNattrak(req, res); });
+
+        port_ = server_.bind_to_any_port("127.0.0.1");
+        if (port_ <= 0)
+        {
+            throw std::runtime_error("Stand-in server could not bind a loopback port");
+        }
+        thread_ = std::thread([this]() { serverThread = true; server_.listen_after_bind(); });
+        server_.wait_until_ready();
+    }
+
+    StandInServer::~StandInServer()
+    {
+        server_.stop();
+        if (thread_.joinable())
+        {
+            thread_.join();
+        }
+    }
+
+    std::string StandInServer::baseUrl(void) const
+    {
+        return "http://127.0.0.1:" + std::to_string(port_);
+    }
+
+    void StandInServer::setAirports(std::vector<std::string> icaos, bool batch)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        icaos_ = std::move(icaos);
+        batch_ = batch;
+    }
+
+    void StandInServer::setStand(const std::string &callsign, const std::string &stand)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stands_[callsign] = stand;
+    }
+
+    void StandInServer::setClearances(std::vector<Clearance> clearances)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        clearances_ = std::move(clearances);
+    }
+
+    void StandInServer::setBatchBody(std::string body)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batchBody_ = std::move(body);
+    }
+
+    void StandInServer::setNattrakBody(std::string body)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nattrakBody_ = std::move(body);
+    }
+
+    void StandInServer::setStatus(const std::string &endpoint, int status)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        statuses_[endpoint] = status;
+    }
+
+    void StandInServer::setDelay(const std::string &endpoint, std::chrono::milliseconds delay)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        delays_[endpoint] = delay;
+    }
+
+    size_t StandInServer::requests(const std::string &endpoint)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return requests_[endpoint];
+    }
+
+    size_t StandInServer::notModified(const std::string &endpoint)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return notModified_[endpoint];
+    }
+
+    std::vector<size_t> StandInServer::batchSizes(void)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return batchSizes_;
+    }
+
+    size_t StandInServer::connections(void)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return remotePorts_.size();
+    }
+
+    bool StandInServer::enter(const std::string &endpoint, const httplib::Request &req, httplib::Response &res)
+    {
+        int status = 0;
+        std::chrono::milliseconds delay(0);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            requests_[endpoint]++;
+            remotePorts_.insert(req.remote_port);
+            status = statuses_[endpoint];
+            delay = delays_[endpoint];
+        }
+        if (delay.count() > 0)
+        {
+            std::this_thread::sleep_for(delay);
+        }
+        if (status != 0)
+        {
+            res.status = status;
+            return false;
+        }
+        return true;
+    }
+
+    void StandInServer::handleAirports(const httplib::Request &req, httplib::Response &res)
+    {
+        if (!enter(AIRPORTS, req, res))
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::ostringstream body;
+        body << "[data]\nicaos = [";
+        for (size_t i = 0; i < icaos_.size(); i++)
+        {
+            body << (i ? ", " : "") << '"' << icaos_[i] << '"';
+        }
+        body << "]\nbatch = " << (batch_ ? "true" : "false") << "\n";
+        res.set_content(body.str(), "application/toml");
+    }
+
+    void StandInServer::handleQuery(const httplib::Request &req, httplib::Response &res)
+    {
+        if (!enter(QUERY, req, res))
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto stand = stands_.find(req.get_param_value("callsign"));
+        if (stand == stands_.end())
+        {
+            res.status = 404;
+            return;
+        }
+        res.set_content("[data]\nstand = \"" + stand->second + "\"\n", "application/toml");
+    }
+
+    void StandInServer::handleBatch(const httplib::Request &req, httplib::Response &res)
+    {
+        if (!enter(BATCH, req, res))
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t count = req.get_param_value_count("flight");
+        batchSizes_.push_back(count);
+        if (!batchBody_.empty())
+        {
+            res.set_content(batchBody_, "application/toml");
+            return;
+        }
+
+        // flight=callsign,dep,arr,wtc
+        std::ostringstream body;
+        body << "[data.stands]\n";
+        for (size_t i = 0; i < count; i++)
+        {
+            std::string flight = req.get_param_value("flight", i);
+            auto stand = stands_.find(flight.substr(0, flight.find(',')));
+            if (stand != stands_.end())
+            {
+                body << stand->first << " = \"" << stand->second << "\"\n";
+            }
+        }
+        res.set_content(body.str(), "application/toml");
+    }
+
+    void StandInServer::handleNattrak(const httplib::Request &req, httplib::Response &res)
+    {
+        if (!enter(NATTRAK, req, res))
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string body = nattrakBody_;
+        if (body.empty())
+        {
+            nlohmann::json clearances = nlohmann::json::array();
+            for (const auto &clearance : clearances_)
+            {
+                clearances.push_back({
+                    {"callsign", clearance.callsign},
+                    {"status", "CLEARED"},
+                    {"level", std::to_string(clearance.flightLevel)},
+                    {"fix", clearance.fix},
+                    {"estimating_time", clearance.estimatingTime},
+                });
+            }
+            body = clearances.dump();
+        }
+
+        if (body != nattrakServed_ || nattrakETag_.empty())
+        {
+            std::ostringstream etag;
+            etag << '"' << std::hex << std::hash<std::string>()(body) << '"';
+            std::time_t now = std::time(nullptr);
+            std::tm utc{};
+#ifdef _WIN32
+            gmtime_s(&utc, &now);
+#else
+            gmtime_r(&now, &utc);
+#endif
+            char lastModified[64];
+            std::strftime(lastModified, sizeof(lastModified), "%a, %d %b %Y %H:%M:%S GMT", &utc);
+            nattrakServed_ = body;
+            nattrakETag_ = etag.str();
+            nattrakLastModified_ = lastModified;
+        }
+        res.set_header("ETag", nattrakETag_);
+        res.set_header("Last-Modified", nattrakLastModified_);
+
+        // If-None-Match wins over If-Modified-Since, as in RFC 9110
+        bool unchanged = req.has_header("If-None-Match") ? req.get_header_value("If-None-Match") == nattrakETag_
+            : req.get_header_value("If-Modified-Since") == nattrakLastModified_;
+        if (unchanged)
+        {
+            notModified_[NATTRAK]++;
+            res.status = 304;
+            return;
+        }
+        res.set_content(body, "application/json");
+    }
+}
@@ -0,0 +1,102 @@
+// StandInServer.h
+#pragma once
+#include <httplib.h>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace StandInServer
+{
+    // Flight known to the stand-in, answered by both the per-flight and the batch query
+    struct Flight
+    {
+        std::string callsign;
+        std::string stand;
+    };
+
+    // Oceanic clearance served on the Nattrak endpoint
+    struct Clearance
+    {
+        std::string callsign;
+        int flightLevel = 0;
+        std::string fix;
+        std::string estimatingTime;
+    };
+
+    // Local httplib server answering like the stand API and Nattrak, on a random
+    // loopback port. Faults are injected per endpoint and requests are counted.
+    // Nattrak answers carry ETag and Last-Modified, a matching conditional request
+    // gets 304, and httplib gzips them for clients sending Accept-Encoding: gzip.
+    class StandInServer
+    {
+        public:
+            static constexpr const char *AIRPORTS = "airports";
+            static constexpr const char *QUERY = "query";
+            static constexpr const char *BATCH = "batch";
+            static constexpr const char *NATTRAK = "nattrak";
+
+            StandInServer();
+            ~StandInServer();
+
+            // http://127.0.0.1:<port>, for Config::gateAssignerApiBase and Config::nattrakApiBase
+            std::string baseUrl(void) const;
+
+            void setAirports(std::vector<std::string> icaos, bool batch);
+            void setStand(const std::string &callsign, const std::string &stand);
+            void setClearances(std::vector<Clearance> clearances);
+
+            // Raw body of the next batch answers, for malformed data
+            void setBatchBody(std::string body);
+
+            // Raw body of the next Nattrak answers instead of the clearances, for recorded payloads
+            void setNattrakBody(std::string body);
+
+            // Answer the endpoint with this status instead of the data, 0 to stop
+            void setStatus(const std::string &endpoint, int status);
+            void setDelay(const std::string &endpoint, std::chrono::milliseconds delay);
+
+            size_t requests(const std::string &endpoint);
+            size_t notModified(const std::string &endpoint); // Requests answered 304
+            std::vector<size_t> batchSizes(void);
+
+            // Distinct client connections seen so far
+            size_t connections(void);
+
+            // True on the threads serving requests, lets the benchmark leave them out of its counts
+            static bool isServerThread(void);
+
+        private:
+            httplib::Server server_;
+            std::thread thread_;
+            int port_ = 0;
+
+            std::mutex mutex_;
+            std::vector<std::string> icaos_;
+            bool batch_ = false;
+            std::map<std::string, std::string> stands_;
+            std::vector<Clearance> clearances_;
+            std::string batchBody_;
+            std::string nattrakBody_;
+            std::string nattrakServed_; // Last Nattrak body served, its validators change with it
+            std::string nattrakETag_;
+            std::string nattrakLastModified_;
+            std::map<std::string, int> statuses_;
+            std::map<std::string, std::chrono::milliseconds> delays_;
+            std::map<std::string, size_t> requests_;
+            std::map<std::string, size_t> notModified_;
+            std::vector<size_t> batchSizes_;
+            std::set<int> remotePorts_;
+
+            // Counts the request and applies the injected faults, false when the data should not be sent
+            bool enter(const std::string &endpoint, const httplib::Request &req, httplib::Response &res);
+            void handleAirports(const httplib::Request &req, httplib::Response &res);
+            void handleQuery(const httplib::Request &req, httplib::Response &res);
+            void handleBatch(const httplib::Request &req, httplib::Response &res);
+            void handleNattrak(const httplib::Request &req, httplib::Response &res);
+    };
+}